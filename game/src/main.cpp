@@ -71,7 +71,6 @@ public:
 
         rebuild_grid();
 
-        resources.refresh_mesh_buffers();
         resources.refresh_bindless_textures();
         resources.refresh_material_buffer();
     }
@@ -207,7 +206,6 @@ public:
 #else
         m_model = scene.add_model(resources.load<kynetic::Model>("assets/models/bistro/Bistro.gltf"));
 #endif
-        resources.refresh_mesh_buffers();
         resources.refresh_bindless_textures();
         resources.refresh_material_buffer();
     }
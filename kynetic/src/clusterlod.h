@@ -142,6 +142,12 @@ struct clodGroup
 // returned value gets saved for clusters emitted from this group (clodCluster::refined)
 typedef int (*clodOutput)(void* output_context, clodGroup group, const clodCluster* clusters, size_t cluster_count);
 
+// work item for clodParallelFor; gets called once for every index in [0, count)
+typedef void (*clodTask)(void* task_context, size_t index);
+
+// should run task for every index in [0, count), possibly concurrently, and return once all of them have completed
+typedef void (*clodParallelFor)(void* scheduler_context, void* task_context, clodTask task, size_t count);
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -155,6 +161,15 @@ extern "C"
     // returns the total number of clusters produced
     size_t clodBuild(clodConfig config, clodMesh mesh, void* output_context, clodOutput output_callback);
 
+    // same as clodBuild, but simplifies and clusterizes the groups of each DAG level through parallel_for
+    // output is identical to clodBuild, and output callbacks are still invoked serially in the same order
+    size_t clodBuildParallel(clodConfig config,
+                             clodMesh mesh,
+                             void* output_context,
+                             clodOutput output_callback,
+                             void* scheduler_context,
+                             clodParallelFor parallel_for);
+
     // extract meshlet-local indices from cluster indices produced by clodBuild
     // fills triangles[] and vertices[] such that vertices[triangles[i]] == indices[i]
     // returns number of unique vertices (which will be equal to clodCluster::vertex_count)
@@ -176,6 +191,26 @@ size_t clodBuild(clodConfig config, clodMesh mesh, Output output)
 
     return clodBuild(config, mesh, &output, &Call::output);
 }
+
+// parallel_for gets called as parallel_for(count, task) where task is callable as task(size_t index)
+template <typename Output, typename ParallelFor>
+size_t clodBuild(clodConfig config, clodMesh mesh, Output output, ParallelFor parallel_for)
+{
+    struct Call
+    {
+        static int output(void* output_context, clodGroup group, const clodCluster* clusters, size_t cluster_count)
+        {
+            return (*static_cast<Output*>(output_context))(group, clusters, cluster_count);
+        }
+
+        static void parallel_for(void* scheduler_context, void* task_context, clodTask task, size_t count)
+        {
+            (*static_cast<ParallelFor*>(scheduler_context))(count, [=](size_t index) { task(task_context, index); });
+        }
+    };
+
+    return clodBuildParallel(config, mesh, &output, &Call::output, &parallel_for, &Call::parallel_for);
+}
 #endif
 
 #ifdef CLUSTERLOD_IMPLEMENTATION
@@ -604,6 +639,65 @@ static int outputGroup(const clodConfig& config,
                            : -1;
 }
 
+struct GroupResult
+{
+    clodBounds bounds;
+
+    // true if simplification got stuck; the group is terminal and split is empty
+    bool terminal;
+
+    std::vector<Cluster> split;
+};
+
+struct SimplifyContext
+{
+    const clodConfig* config;
+    const clodMesh* mesh;
+    const std::vector<Cluster>* clusters;
+    const std::vector<std::vector<int>>* groups;
+    const std::vector<unsigned char>* locks;
+    std::vector<GroupResult>* results;
+};
+
+// groups within one level only read shared state (clusters, locks), so they can be processed in any order or concurrently
+static void simplifyGroup(void* task_context, size_t index)
+{
+    const SimplifyContext& context = *static_cast<const SimplifyContext*>(task_context);
+    const clodConfig& config = *context.config;
+    const clodMesh& mesh = *context.mesh;
+    const std::vector<Cluster>& clusters = *context.clusters;
+    const std::vector<int>& group = (*context.groups)[index];
+    GroupResult& result = (*context.results)[index];
+
+    std::vector<unsigned int> merged;
+    merged.reserve(group.size() * config.max_triangles * 3);
+    for (size_t j = 0; j < group.size(); ++j)
+        merged.insert(merged.end(), clusters[group[j]].indices.begin(), clusters[group[j]].indices.end());
+
+    size_t target_size = size_t((merged.size() / 3) * config.simplify_ratio) * 3;
+
+    // enforce bounds and error monotonicity
+    // note: it is incorrect to use the precise bounds of the merged or simplified mesh, because this may violate
+    // monotonicity
+    result.bounds = boundsMerge(clusters, group);
+
+    float error = 0.f;
+    std::vector<unsigned int> simplified = simplify(config, mesh, merged, *context.locks, target_size, &error);
+    if (simplified.size() > merged.size() * config.simplify_threshold)
+    {
+        result.bounds.error = FLT_MAX;  // terminal group, won't simplify further
+        result.terminal = true;
+        return;  // simplification is stuck; abandon the merge
+    }
+
+    // enforce error monotonicity (with an optional hierarchical factor to separate transitions more)
+    result.bounds.error =
+        std::max(result.bounds.error * config.simplify_error_merge_previous, error) + error * config.simplify_error_merge_additive;
+    result.terminal = false;
+
+    result.split = clusterize(config, mesh, simplified.data(), simplified.size());
+}
+
 }  // namespace clod
 
 clodConfig clodDefaultConfig(size_t max_triangles)
@@ -658,6 +752,16 @@ clodConfig clodDefaultConfigRT(size_t max_triangles)
 }
 
 size_t clodBuild(clodConfig config, clodMesh mesh, void* output_context, clodOutput output_callback)
+{
+    return clodBuildParallel(config, mesh, output_context, output_callback, NULL, NULL);
+}
+
+size_t clodBuildParallel(clodConfig config,
+                         clodMesh mesh,
+                         void* output_context,
+                         clodOutput output_callback,
+                         void* scheduler_context,
+                         clodParallelFor parallel_for)
 {
     using namespace clod;
 
@@ -708,49 +812,39 @@ size_t clodBuild(clodConfig config, clodMesh mesh, void* output_context, clodOut
         // mark boundaries between groups with a lock bit to avoid gaps in simplified result
         lockBoundary(locks, groups, clusters, remap, mesh.vertex_lock);
 
-        // every group needs to be simplified now
-        for (size_t i = 0; i < groups.size(); ++i)
-        {
-            std::vector<unsigned int> merged;
-            merged.reserve(groups[i].size() * config.max_triangles * 3);
-            for (size_t j = 0; j < groups[i].size(); ++j)
-                merged.insert(merged.end(), clusters[groups[i][j]].indices.begin(), clusters[groups[i][j]].indices.end());
+        // every group needs to be simplified now; this is the expensive part and each group is independent
+        std::vector<GroupResult> results(groups.size());
+        SimplifyContext context = {&config, &mesh, &clusters, &groups, &locks, &results};
 
-            size_t target_size = size_t((merged.size() / 3) * config.simplify_ratio) * 3;
+        if (parallel_for)
+            parallel_for(scheduler_context, &context, simplifyGroup, groups.size());
+        else
+            for (size_t i = 0; i < groups.size(); ++i) simplifyGroup(&context, i);
 
-            // enforce bounds and error monotonicity
-            // note: it is incorrect to use the precise bounds of the merged or simplified mesh, because this may violate
-            // monotonicity
-            clodBounds bounds = boundsMerge(clusters, groups[i]);
+        // output groups and append new clusters in group order, which keeps the result identical to a serial build
+        for (size_t i = 0; i < groups.size(); ++i)
+        {
+            GroupResult& result = results[i];
 
-            float error = 0.f;
-            std::vector<unsigned int> simplified = simplify(config, mesh, merged, locks, target_size, &error);
-            if (simplified.size() > merged.size() * config.simplify_threshold)
+            if (result.terminal)
             {
-                bounds.error = FLT_MAX;  // terminal group, won't simplify further
-                outputGroup(config, mesh, clusters, groups[i], bounds, depth, output_context, output_callback);
-                continue;  // simplification is stuck; abandon the merge
+                outputGroup(config, mesh, clusters, groups[i], result.bounds, depth, output_context, output_callback);
+                continue;
             }
 
-            // enforce error monotonicity (with an optional hierarchical factor to separate transitions more)
-            bounds.error = std::max(bounds.error * config.simplify_error_merge_previous, error) +
-                           error * config.simplify_error_merge_additive;
-
             // output the new group with all clusters; the resulting id will be recorded in new clusters as clodCluster::refined
-            int refined = outputGroup(config, mesh, clusters, groups[i], bounds, depth, output_context, output_callback);
+            int refined = outputGroup(config, mesh, clusters, groups[i], result.bounds, depth, output_context, output_callback);
 
             // discard clusters from the group - they won't be used anymore
             for (size_t j = 0; j < groups[i].size(); ++j) clusters[groups[i][j]].indices = std::vector<unsigned int>();
 
-            std::vector<Cluster> split = clusterize(config, mesh, simplified.data(), simplified.size());
-
-            for (Cluster& cluster : split)
+            for (Cluster& cluster : result.split)
             {
                 cluster.refined = refined;
 
                 // update cluster group bounds to the group-merged bounds; this ensures that we compute the group bounds for
                 // whatever group this cluster will be part of conservatively
-                cluster.bounds = bounds;
+                cluster.bounds = result.bounds;
 
                 // enqueue new cluster for further processing
                 clusters.push_back(std::move(cluster));
@@ -11,6 +11,9 @@
 #include "engine.hpp"
 #include "input.hpp"
 #include "rendering/swapchain.hpp"
+#include "rendering/texture_compression.hpp"
+#include "rendering/upload_batch.hpp"
+#include "rendering/uploader.hpp"
 
 KX_DISABLE_WARNING_PUSH
 KX_DISABLE_WARNING_OUTSIDE_RANGE
@@ -22,6 +25,9 @@ KX_DISABLE_WARNING_POP
 
 using namespace kynetic;
 
+// Enough for two default sized UploadBatch flushes, so one can be filled while the other is copied.
+constexpr size_t UPLOAD_RING_SIZE = 128ull * 1024 * 1024;
+
 Device::Device()
 {
     VK_CHECK(volkInitialize());
@@ -65,6 +71,7 @@ Device::Device()
     features_12.runtimeDescriptorArray = true;
     features_12.shaderInt8 = true;
     features_12.samplerFilterMinmax = true;
+    features_12.timelineSemaphore = true;
 
     VkPhysicalDeviceVulkan13Features features_13{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES};
     features_13.dynamicRendering = true;
@@ -88,6 +95,11 @@ Device::Device()
                                               .value();
     m_physical_device = physical_device.physical_device;
 
+    // Block compressed textures are optional, imports fall back to uncompressed RGBA8 without them.
+    VkPhysicalDeviceFeatures optional_features{};
+    optional_features.textureCompressionBC = true;
+    m_supports_bc_compression = physical_device.enable_features_if_present(optional_features);
+
     vkb::Device device = vkb::DeviceBuilder(physical_device).add_pNext(&mesh_shader_features).build().value();
     m_device = device.device;
     volkLoadDevice(m_device);
@@ -100,6 +112,20 @@ Device::Device()
     m_queue_indices = {.graphics = device.get_queue_index(vkb::QueueType::graphics).value(),
                        .present = device.get_queue_index(vkb::QueueType::present).value()};
 
+    // Prefer a transfer family without graphics, copies on it run on the DMA engines alongside rendering.
+    if (auto transfer_queue = device.get_queue(vkb::QueueType::transfer))
+    {
+        m_transfer_queue = transfer_queue.value();
+        m_queue_indices.transfer = device.get_queue_index(vkb::QueueType::transfer).value();
+    }
+    else
+    {
+        m_transfer_queue = m_graphics_queue;
+        m_queue_indices.transfer = m_queue_indices.graphics;
+    }
+    m_upload_queue_families[0] = m_queue_indices.graphics;
+    m_upload_queue_families[1] = m_queue_indices.transfer;
+
     size_t swapchain_image_count = m_swapchain->m_images.size();
     m_syncs.resize(swapchain_image_count);
 
@@ -125,6 +151,8 @@ Device::Device()
     };
     vmaCreateAllocator(&allocator_info, &m_allocator);
 
+    m_uploader = std::make_unique<Uploader>(*this, m_transfer_queue, m_queue_indices.transfer, UPLOAD_RING_SIZE);
+
     init_bindless();
 
     std::vector<PoolSizeRatio> frame_sizes = {
@@ -203,6 +231,8 @@ Device::~Device()
     vkDestroyFence(m_device, m_immediate_fence, nullptr);
     m_immediate_command_buffer.shutdown();
 
+    for (const RetiredBuffer& retired : m_retired_buffers) destroy_buffer(retired.buffer);
+
     for (auto& ctx : m_ctxs)
     {
         ctx.deletion_queue.flush();
@@ -213,6 +243,8 @@ Device::~Device()
     vkDestroyDescriptorSetLayout(m_device, m_bindless_layout, nullptr);
     m_bindless_allocator.destroy_pool();
 
+    m_uploader.reset();
+
     vmaDestroyAllocator(m_allocator);
 
     for (auto sync : m_syncs)
@@ -246,6 +278,14 @@ bool Device::begin_frame()
     ctx.deletion_queue.flush();
     ctx.allocator.clear_descriptors();
 
+    // The fence above belongs to frame m_frame_count - m_syncs.size(), which finished after every frame before it.
+    while (!m_retired_buffers.empty() && m_retired_buffers.front().frame + m_syncs.size() <= m_frame_count &&
+           m_uploader->is_complete(m_retired_buffers.front().token))
+    {
+        destroy_buffer(m_retired_buffers.front().buffer);
+        m_retired_buffers.pop_front();
+    }
+
     VkResult result = m_swapchain->acquire_next_image(m_syncs[frame_index].image_available);
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR)
@@ -291,11 +331,18 @@ void Device::end_frame()
 
     VkCommandBufferSubmitInfo command_buffer_info = vk_init::command_buffer_submit_info(ctx.dcb.m_command_buffer);
 
-    VkSemaphoreSubmitInfo wait_info = vk_init::semaphore_submit_info(VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,
-                                                                     m_syncs[frame_index].image_available);
+    // The frame may use anything uploaded so far, the GPU waits for the copies instead of the CPU.
+    VkSemaphoreSubmitInfo wait_infos[2] = {
+        vk_init::semaphore_submit_info(VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,
+                                       m_syncs[frame_index].image_available),
+        vk_init::semaphore_submit_info(VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_uploader->get_timeline()),
+    };
+    wait_infos[1].value = m_uploader->get_last_token();
+
     VkSemaphoreSubmitInfo signal_info =
         vk_init::semaphore_submit_info(VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT, m_syncs[image_index].render_finished);
-    VkSubmitInfo2 submit = vk_init::submit_info(&command_buffer_info, &signal_info, &wait_info);
+    VkSubmitInfo2 submit = vk_init::submit_info(&command_buffer_info, &signal_info, wait_infos);
+    submit.waitSemaphoreInfoCount = static_cast<uint32_t>(std::size(wait_infos));
 
     VK_CHECK(vkQueueSubmit2(m_graphics_queue, 1, &submit, m_syncs[frame_index].in_flight_fence));
 
@@ -454,6 +501,15 @@ AllocatedImage Device::create_image(const VkExtent2D extent,
                         aspect_flags);
 }
 
+void Device::share_with_uploads(VkImageCreateInfo& create_info) const
+{
+    if (!has_transfer_queue() || !(create_info.usage & VK_IMAGE_USAGE_TRANSFER_DST_BIT)) return;
+
+    create_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+    create_info.queueFamilyIndexCount = static_cast<uint32_t>(std::size(m_upload_queue_families));
+    create_info.pQueueFamilyIndices = m_upload_queue_families;
+}
+
 AllocatedImage Device::create_image(VkExtent3D size, VkFormat format, VkImageUsageFlags usage, bool mipmapped) const
 {
     AllocatedImage new_image;
@@ -462,6 +518,7 @@ AllocatedImage Device::create_image(VkExtent3D size, VkFormat format, VkImageUsa
 
     VkImageCreateInfo img_info = vk_init::image_create_info(format, usage, size);
     if (mipmapped) img_info.mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(size.width, size.height)))) + 1;
+    share_with_uploads(img_info);
 
     VmaAllocationCreateInfo alloc_info = {};
     alloc_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
@@ -480,7 +537,11 @@ AllocatedImage Device::create_image(VkExtent3D size, VkFormat format, VkImageUsa
     return new_image;
 }
 
-AllocatedImage Device::create_image(VkExtent3D size, VkFormat format, VkImageUsageFlags usage, uint32_t mips) const
+AllocatedImage Device::create_image(VkExtent3D size,
+                                    VkFormat format,
+                                    VkImageUsageFlags usage,
+                                    uint32_t mips,
+                                    VkComponentMapping components) const
 {
     AllocatedImage new_image;
     new_image.format = format;
@@ -488,6 +549,7 @@ AllocatedImage Device::create_image(VkExtent3D size, VkFormat format, VkImageUsa
 
     VkImageCreateInfo img_info = vk_init::image_create_info(format, usage, size);
     img_info.mipLevels = mips;
+    share_with_uploads(img_info);
 
     VmaAllocationCreateInfo alloc_info = {};
     alloc_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
@@ -500,6 +562,7 @@ AllocatedImage Device::create_image(VkExtent3D size, VkFormat format, VkImageUsa
 
     VkImageViewCreateInfo view_info = vk_init::imageview_create_info(format, new_image.image, aspectFlag);
     view_info.subresourceRange.levelCount = img_info.mipLevels;
+    view_info.components = components;
 
     VK_CHECK(vkCreateImageView(m_device, &view_info, nullptr, &new_image.view));
 
@@ -508,14 +571,27 @@ AllocatedImage Device::create_image(VkExtent3D size, VkFormat format, VkImageUsa
 
 AllocatedImage Device::create_image(void* data, VkExtent3D size, VkFormat format, VkImageUsageFlags usage, bool mipmapped)
 {
-    size_t data_size = size.depth * size.width * size.height * 4;
+    // Block compressed formats can't be blitted, their mips have to be provided up front (see TextureData).
+    KX_ASSERT_MSG(!mipmapped || !texture_compression::is_block_compressed(format),
+                  "GPU mip generation is not supported for block compressed formats");
 
-    AllocatedBuffer upload_buffer = create_buffer(data_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
-    memcpy(upload_buffer.info.pMappedData, data, data_size);
+    const size_t data_size = texture_compression::get_level_size(format, size.width, size.height) * size.depth;
 
     AllocatedImage new_image =
         create_image(size, format, usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, mipmapped);
 
+    if (!mipmapped)
+    {
+        UploadBatch uploads;
+        uploads.upload(new_image, data, data_size);
+        uploads.flush();
+        return new_image;
+    }
+
+    // Mips are blitted, which only the graphics queue can do.
+    AllocatedBuffer upload_buffer = create_buffer(data_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+    memcpy(upload_buffer.info.pMappedData, data, data_size);
+
     immediate_submit(
         [&](const CommandBuffer& cmd)
         {
@@ -538,9 +614,7 @@ AllocatedImage Device::create_image(void* data, VkExtent3D size, VkFormat format
                                      1,
                                      &copy_region);
 
-            cmd.transition_image(new_image.image,
-                                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            vk_util::generate_mipmaps(cmd.m_command_buffer, new_image.image, {size.width, size.height});
         });
 
     destroy_buffer(upload_buffer);
@@ -554,21 +628,34 @@ void Device::destroy_image(const AllocatedImage& image) const
     vmaDestroyImage(m_allocator, image.image, image.allocation);
 }
 
-AllocatedBuffer Device::create_buffer(size_t size, VkBufferUsageFlags usage, VmaMemoryUsage memory_usage) const
+AllocatedBuffer Device::create_buffer(size_t size,
+                                      VkBufferUsageFlags usage,
+                                      VmaMemoryUsage memory_usage,
+                                      VmaAllocationCreateFlags flags) const
 {
     VkBufferCreateInfo bufferInfo = {.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
     bufferInfo.pNext = nullptr;
     bufferInfo.size = size;
     bufferInfo.usage = usage;
+    if (has_transfer_queue() && (usage & VK_BUFFER_USAGE_TRANSFER_DST_BIT))
+    {
+        bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(std::size(m_upload_queue_families));
+        bufferInfo.pQueueFamilyIndices = m_upload_queue_families;
+    }
 
     VmaAllocationCreateInfo vmaallocInfo = {};
     vmaallocInfo.usage = memory_usage;
-    vmaallocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    vmaallocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT | flags;
     AllocatedBuffer new_buffer;
 
     VK_CHECK(
         vmaCreateBuffer(m_allocator, &bufferInfo, &vmaallocInfo, &new_buffer.buffer, &new_buffer.allocation, &new_buffer.info));
 
+    VkMemoryPropertyFlags memory_properties;
+    vmaGetAllocationMemoryProperties(m_allocator, new_buffer.allocation, &memory_properties);
+    if (!(memory_properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)) new_buffer.info.pMappedData = nullptr;
+
     return new_buffer;
 }
 
@@ -577,6 +664,11 @@ void Device::destroy_buffer(const AllocatedBuffer& buffer) const
     vmaDestroyBuffer(m_allocator, buffer.buffer, buffer.allocation);
 }
 
+void Device::retire_buffer(const AllocatedBuffer& buffer)
+{
+    m_retired_buffers.push_back({buffer, m_frame_count, m_uploader->get_last_token()});
+}
+
 void Device::wait_idle() const { vkDeviceWaitIdle(m_device); }
 
 void Device::immediate_submit(std::function<void(CommandBuffer& cmd)>&& function)
@@ -6,6 +6,7 @@
 
 #include "rendering/command_buffer.hpp"
 #include "rendering/descriptor.hpp"
+#include "rendering/uploader.hpp"
 
 struct SDL_Window;
 
@@ -22,6 +23,7 @@ struct QueueIndices
 {
     uint32_t graphics;
     uint32_t present;
+    uint32_t transfer;
 };
 
 class Device
@@ -35,6 +37,13 @@ class Device
         VkFence in_flight_fence;
     };
 
+    struct RetiredBuffer
+    {
+        AllocatedBuffer buffer;
+        uint32_t frame;
+        UploadToken token;
+    };
+
     SDL_Window* m_window{nullptr};
     VkExtent2D m_window_extent{1024, 768};
 
@@ -48,6 +57,10 @@ class Device
     QueueIndices m_queue_indices;
     VkQueue m_graphics_queue;
     VkQueue m_present_queue;
+    VkQueue m_transfer_queue;
+
+    // Resources written on the transfer queue are shared with the graphics family instead of changing owners.
+    uint32_t m_upload_queue_families[2];
 
     VmaAllocator m_allocator;
 
@@ -59,6 +72,10 @@ class Device
     std::vector<Sync> m_syncs;
 
     std::unique_ptr<class Swapchain> m_swapchain;
+    std::unique_ptr<Uploader> m_uploader;
+
+    // Oldest first, destroyed once no frame or upload submitted before their retirement can still read them.
+    std::deque<RetiredBuffer> m_retired_buffers;
 
     VkFence m_immediate_fence;
 
@@ -72,10 +89,14 @@ class Device
     bool m_is_minimized{false};
     bool m_is_running{true};
     bool m_resize_requested{false};
+    bool m_supports_bc_compression{false};
 
     void init_bindless();
     void resize_swapchain();
 
+    [[nodiscard]] bool has_transfer_queue() const { return m_queue_indices.transfer != m_queue_indices.graphics; }
+    void share_with_uploads(VkImageCreateInfo& create_info) const;
+
     bool begin_frame();
     void end_frame();
 
@@ -107,9 +128,13 @@ public:
 
     [[nodiscard]] VmaAllocator get_allocator() const { return m_allocator; };
 
+    [[nodiscard]] Uploader& uploader() const { return *m_uploader; }
+
     [[nodiscard]] VkDescriptorSetLayout& get_bindless_set_layout() { return m_bindless_layout; }
     [[nodiscard]] VkDescriptorSet& get_bindless_set() { return m_bindless_set; }
 
+    [[nodiscard]] bool supports_bc_compression() const { return m_supports_bc_compression; }
+
     bool is_minimized() const;
     bool is_running() const;
 
@@ -128,15 +153,27 @@ public:
                                 VkImageAspectFlags aspect_flags) const;
 
     AllocatedImage create_image(VkExtent3D size, VkFormat format, VkImageUsageFlags usage, bool mipmapped = false) const;
-    AllocatedImage create_image(VkExtent3D size, VkFormat format, VkImageUsageFlags usage, uint32_t mips) const;
+    AllocatedImage create_image(VkExtent3D size,
+                                VkFormat format,
+                                VkImageUsageFlags usage,
+                                uint32_t mips,
+                                VkComponentMapping components = {}) const;
     AllocatedImage create_image(void* data, VkExtent3D size, VkFormat format, VkImageUsageFlags usage, bool mipmapped = false);
 
     void destroy_image(const AllocatedImage& image) const;
 
-    AllocatedBuffer create_buffer(size_t size, VkBufferUsageFlags usage, VmaMemoryUsage memory_usage) const;
+    // Buffers are always created persistently mapped when their memory is host visible, info.pMappedData is null otherwise.
+    // Passing VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT lets VMA fall back to unmappable memory.
+    AllocatedBuffer create_buffer(size_t size,
+                                  VkBufferUsageFlags usage,
+                                  VmaMemoryUsage memory_usage,
+                                  VmaAllocationCreateFlags flags = 0) const;
     void destroy_buffer(const AllocatedBuffer& buffer) const;
+    // Destroys buffer once every frame and upload submitted so far is done with it, without waiting for them.
+    void retire_buffer(const AllocatedBuffer& buffer);
 
     void wait_idle() const;
+    // Blocking submit to the graphics queue, only for work the transfer queue can't do. Uploads go through the Uploader.
     void immediate_submit(std::function<void(CommandBuffer& cmd)>&& function);
 };
 }  // namespace kynetic
\ No newline at end of file
@@ -2,6 +2,7 @@
 // Created by kenny on 11/4/25.
 //
 
+#include "thread_pool.hpp"
 #include "device.hpp"
 #include "input.hpp"
 #include "resource_manager.hpp"
@@ -19,6 +20,7 @@ Engine::Engine()
     KX_ASSERT_MSG(engine == nullptr, "There can only be one Engine object.");
     engine = this;
 
+    m_thread_pool = std::make_unique<ThreadPool>();
     m_device = std::make_unique<Device>();
     m_input = std::make_unique<Input>();
     m_resource_manager = std::make_unique<ResourceManager>();
@@ -8,6 +8,7 @@ namespace kynetic
 {
 class Engine
 {
+    std::unique_ptr<class ThreadPool> m_thread_pool;
     std::unique_ptr<class Device> m_device;
     std::unique_ptr<class Input> m_input;
     std::unique_ptr<class ResourceManager> m_resource_manager;
@@ -30,6 +31,7 @@ public:
 
     [[nodiscard]] static Engine& get();
 
+    [[nodiscard]] ThreadPool& threads() const { return *m_thread_pool; }
     [[nodiscard]] Device& device() const { return *m_device; }
     [[nodiscard]] Input& input() const { return *m_input; }
     [[nodiscard]] ResourceManager& resources() const { return *m_resource_manager; }
@@ -0,0 +1,53 @@
+//
+// Created by kenny on 12/1/25.
+//
+
+#pragma once
+
+namespace kynetic
+{
+
+// Fast non-cryptographic 64-bit hash, used for cache keys. Not stable across endianness.
+inline uint64_t hash_mix(uint64_t value)
+{
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdull;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ull;
+    value ^= value >> 33;
+    return value;
+}
+
+inline uint64_t hash_combine(uint64_t seed, uint64_t value)
+{
+    return hash_mix(seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2)));
+}
+
+inline uint64_t hash_bytes(const void* data, size_t size, uint64_t seed = 0)
+{
+    const auto* bytes = static_cast<const uint8_t*>(data);
+
+    uint64_t h = seed ^ (size * 0x9e3779b97f4a7c15ull);
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, bytes + i, sizeof(word));
+        h = (h ^ hash_mix(word)) * 0x9e3779b97f4a7c15ull;
+        h = (h << 31) | (h >> 33);
+    }
+
+    uint64_t tail = 0;
+    for (size_t j = 0; i + j < size; ++j) tail |= static_cast<uint64_t>(bytes[i + j]) << (j * 8);
+
+    return hash_mix(h ^ hash_mix(tail));
+}
+
+template <typename T>
+uint64_t hash_span(std::span<const T> span, uint64_t seed = 0)
+{
+    return hash_bytes(span.data(), span.size_bytes(), seed);
+}
+
+}  // namespace kynetic
@@ -0,0 +1,122 @@
+//
+// Created by kenny on 12/5/25.
+//
+
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace kynetic;
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+    HANDLE file = CreateFileW(path.c_str(),
+                              GENERIC_READ,
+                              FILE_SHARE_READ,
+                              nullptr,
+                              OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE) return;
+    m_file = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        close();
+        return;
+    }
+
+    m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping)
+    {
+        close();
+        return;
+    }
+
+    m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    m_size = m_data ? static_cast<size_t>(size.QuadPart) : 0;
+    if (!m_data) close();
+}
+
+void MappedFile::close()
+{
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(m_mapping);
+    if (m_file) CloseHandle(m_file);
+
+    m_data = nullptr;
+    m_size = 0;
+    m_mapping = nullptr;
+    m_file = nullptr;
+}
+#else
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+    m_file = open(path.c_str(), O_RDONLY);
+    if (m_file < 0) return;
+
+    struct stat status{};
+    if (fstat(m_file, &status) != 0 || status.st_size == 0)
+    {
+        close();
+        return;
+    }
+
+    void* data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, m_file, 0);
+    if (data == MAP_FAILED)
+    {
+        close();
+        return;
+    }
+
+    m_data = static_cast<const uint8_t*>(data);
+    m_size = static_cast<size_t>(status.st_size);
+
+    // Files are mostly read front to back, let the kernel read ahead aggressively.
+    madvise(data, m_size, MADV_SEQUENTIAL);
+    madvise(data, m_size, MADV_WILLNEED);
+}
+
+void MappedFile::close()
+{
+    if (m_data) munmap(const_cast<uint8_t*>(m_data), m_size);
+    if (m_file >= 0) ::close(m_file);
+
+    m_data = nullptr;
+    m_size = 0;
+    m_file = -1;
+}
+#endif
+
+MappedFile::~MappedFile() { close(); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this == &other) return *this;
+
+    close();
+
+    m_data = std::exchange(other.m_data, nullptr);
+    m_size = std::exchange(other.m_size, 0);
+#ifdef _WIN32
+    m_mapping = std::exchange(other.m_mapping, nullptr);
+    m_file = std::exchange(other.m_file, nullptr);
+#else
+    m_file = std::exchange(other.m_file, -1);
+#endif
+
+    return *this;
+}
@@ -0,0 +1,42 @@
+//
+// Created by kenny on 12/5/25.
+//
+
+#pragma once
+
+namespace kynetic
+{
+
+// Read-only memory mapping of a whole file. Pages are faulted in by the OS as they're touched, so copying out of data()
+// reads straight from the page cache without an intermediate heap copy.
+class MappedFile
+{
+    const uint8_t* m_data{nullptr};
+    size_t m_size{0};
+
+#ifdef _WIN32
+    void* m_file{nullptr};
+    void* m_mapping{nullptr};
+#else
+    int m_file{-1};
+#endif
+
+    void close();
+
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    [[nodiscard]] bool is_open() const { return m_data != nullptr; }
+
+    [[nodiscard]] const uint8_t* data() const { return m_data; }
+    [[nodiscard]] size_t size() const { return m_size; }
+};
+
+}  // namespace kynetic
@@ -263,14 +263,17 @@ void Renderer::render_frustum_lines()
 
     ctx.dcb.begin_label("Debug Frustum Lines", 1.0f, 1.0f, 0.0f);
 
+    // Host visible device memory on resizable BAR hardware, host memory the GPU reads over the bus otherwise.
     size_t buffer_size = frustum_lines.size() * sizeof(DebugLineVertex);
     AllocatedBuffer line_buffer = device.create_buffer(
         buffer_size,
-        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-        VMA_MEMORY_USAGE_CPU_TO_GPU);
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+        VMA_MEMORY_USAGE_AUTO,
+        VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT);
     ctx.deletion_queue.push_function([=, &device] { device.destroy_buffer(line_buffer); });
 
     memcpy(line_buffer.info.pMappedData, frustum_lines.data(), buffer_size);
+    VK_CHECK(vmaFlushAllocation(device.get_allocator(), line_buffer.allocation, 0, buffer_size));
 
     VkDeviceAddress line_buffer_address;
     {
@@ -603,8 +606,8 @@ void Renderer::render()
                 ctx.dcb.bind_pipeline(m_lit_pipeline.get());
 
                 DrawPushConstants push_constants;
-                push_constants.positions = resources.m_merged_position_buffer_address;
-                push_constants.vertices = resources.m_merged_vertex_buffer_address;
+                push_constants.positions = resources.geometry().get_address(GeometryPool::Vertices, 0);
+                push_constants.vertices = resources.geometry().get_address(GeometryPool::Vertices, 1);
                 push_constants.materials = resources.m_material_buffer_address;
                 push_constants.instances = debug_settings.render_mode == RenderMode::GpuDriven
                                                ? scene.get_instance_output_buffer_address()
@@ -613,7 +616,6 @@ void Renderer::render()
                 ctx.dcb.set_push_constants(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
                                            sizeof(DrawPushConstants),
                                            &push_constants);
-                ctx.dcb.bind_index_buffer(resources.m_merged_index_buffer.buffer, VK_INDEX_TYPE_UINT32);
 
                 VkDescriptorSet scene_descriptor = ctx.allocator.allocate(m_lit_pipeline->get_set_layout(0));
                 {
@@ -5,19 +5,25 @@
 #include "device.hpp"
 #include "engine.hpp"
 
+#include "rendering/geometry_arena.hpp"
 #include "rendering/texture.hpp"
 #include "rendering/mesh.hpp"
 #include "rendering/material.hpp"
+#include "rendering/upload_batch.hpp"
 
 #include "resource_manager.hpp"
 
 using namespace kynetic;
 ResourceManager::ResourceManager()
 {
+    m_geometry = std::make_unique<GeometryArena>(Engine::get().device());
+
     VkSamplerCreateInfo nearest_sampler{
         .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
         .magFilter = VK_FILTER_NEAREST,
         .minFilter = VK_FILTER_NEAREST,
+        .mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+        .maxLod = VK_LOD_CLAMP_NONE,
     };
 
     uint32_t white = glm::packUnorm4x8(glm::vec4(1.f, 1.f, 1.f, 1.f));
@@ -54,100 +60,16 @@ ResourceManager::ResourceManager()
                                                VkExtent3D{16, 16, 1},
                                                VK_FORMAT_R8G8B8A8_UNORM,
                                                VK_IMAGE_USAGE_SAMPLED_BIT,
-                                               nearest_sampler));
+                                               nearest_sampler,
+                                               true));
 }
 ResourceManager::~ResourceManager()
 {
     Device& device = Engine::get().device();
 
-    if (m_merged_index_buffer.buffer != VK_NULL_HANDLE) device.destroy_buffer(m_merged_index_buffer);
-    if (m_merged_position_buffer.buffer != VK_NULL_HANDLE) device.destroy_buffer(m_merged_position_buffer);
-    if (m_merged_vertex_buffer.buffer != VK_NULL_HANDLE) device.destroy_buffer(m_merged_vertex_buffer);
     if (m_material_buffer.buffer != VK_NULL_HANDLE) device.destroy_buffer(m_material_buffer);
 }
 
-void ResourceManager::refresh_mesh_buffers()
-{
-    Device& device = Engine::get().device();
-
-    if (m_merged_vertex_buffer.buffer != VK_NULL_HANDLE) device.destroy_buffer(m_merged_vertex_buffer);
-    if (m_merged_position_buffer.buffer != VK_NULL_HANDLE) device.destroy_buffer(m_merged_position_buffer);
-    if (m_merged_index_buffer.buffer != VK_NULL_HANDLE) device.destroy_buffer(m_merged_index_buffer);
-
-    size_t total_vertices = 0;
-    size_t total_indices = 0;
-
-    for_each<Mesh>(
-        [&](const std::shared_ptr<Mesh>& mesh)
-        {
-            mesh->m_first_index = static_cast<uint32_t>(total_indices);
-            mesh->m_first_vertex = static_cast<uint32_t>(total_vertices);
-
-            total_vertices += mesh->m_vertex_count;
-            total_indices += mesh->m_index_count;
-        });
-
-    m_merged_index_buffer = device.create_buffer(total_indices * sizeof(uint32_t),
-                                                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
-                                                     VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
-                                                     VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-                                                 VMA_MEMORY_USAGE_GPU_ONLY);
-    {
-        VkBufferDeviceAddressInfo device_address_info{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-                                                      .buffer = m_merged_index_buffer.buffer};
-        m_merged_index_buffer_address = vkGetBufferDeviceAddress(device.get(), &device_address_info);
-    }
-
-    m_merged_position_buffer = device.create_buffer(
-        total_vertices * sizeof(glm::vec4),
-        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-        VMA_MEMORY_USAGE_GPU_ONLY);
-    {
-        VkBufferDeviceAddressInfo device_address_info{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-                                                      .buffer = m_merged_position_buffer.buffer};
-        m_merged_position_buffer_address = vkGetBufferDeviceAddress(device.get(), &device_address_info);
-    }
-
-    m_merged_vertex_buffer = device.create_buffer(
-        total_vertices * sizeof(Vertex),
-        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-        VMA_MEMORY_USAGE_GPU_ONLY);
-    {
-        VkBufferDeviceAddressInfo device_address_info{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-                                                      .buffer = m_merged_vertex_buffer.buffer};
-        m_merged_vertex_buffer_address = vkGetBufferDeviceAddress(device.get(), &device_address_info);
-    }
-
-    device.immediate_submit(
-        [&](const CommandBuffer& cmd)
-        {
-            for_each<Mesh>(
-                [&](const std::shared_ptr<Mesh>& mesh)
-                {
-                    VkBufferCopy index_copy;
-                    index_copy.dstOffset = mesh->m_first_index * sizeof(uint32_t);
-                    index_copy.size = mesh->m_index_count * sizeof(uint32_t);
-                    index_copy.srcOffset = 0;
-
-                    cmd.copy_buffer(mesh->m_index_buffer.buffer, m_merged_index_buffer.buffer, 1, &index_copy);
-
-                    VkBufferCopy position_copy;
-                    position_copy.dstOffset = mesh->m_first_vertex * sizeof(glm::vec4);
-                    position_copy.size = mesh->m_vertex_count * sizeof(glm::vec4);
-                    position_copy.srcOffset = 0;
-
-                    cmd.copy_buffer(mesh->m_position_buffer.buffer, m_merged_position_buffer.buffer, 1, &position_copy);
-
-                    VkBufferCopy vertex_copy;
-                    vertex_copy.dstOffset = mesh->m_first_vertex * sizeof(Vertex);
-                    vertex_copy.size = mesh->m_vertex_count * sizeof(Vertex);
-                    vertex_copy.srcOffset = 0;
-
-                    cmd.copy_buffer(mesh->m_vertex_buffer.buffer, m_merged_vertex_buffer.buffer, 1, &vertex_copy);
-                });
-        });
-}
-
 void ResourceManager::refresh_material_buffer()
 {
     Device& device = Engine::get().device();
@@ -179,28 +101,9 @@ void ResourceManager::refresh_material_buffer()
                                                   .buffer = m_material_buffer.buffer};
     m_material_buffer_address = vkGetBufferDeviceAddress(device.get(), &device_address_info);
 
-    size_t material_buffer_size = material_datas.size() * sizeof(MaterialData);
-
-    AllocatedBuffer staging =
-        device.create_buffer(material_buffer_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY);
-
-    void* data;
-    vmaMapMemory(device.get_allocator(), staging.allocation, &data);
-    memcpy(data, material_datas.data(), material_buffer_size);
-    vmaUnmapMemory(device.get_allocator(), staging.allocation);
-
-    device.immediate_submit(
-        [&](const CommandBuffer& cmd)
-        {
-            VkBufferCopy copy;
-            copy.dstOffset = 0;
-            copy.size = material_buffer_size;
-            copy.srcOffset = 0;
-
-            cmd.copy_buffer(staging.buffer, m_material_buffer.buffer, 1, &copy);
-        });
-
-    device.destroy_buffer(staging);
+    UploadBatch uploads;
+    uploads.upload(m_material_buffer.buffer, 0, material_datas.data(), material_datas.size() * sizeof(MaterialData));
+    uploads.flush();
 }
 
 void ResourceManager::refresh_bindless_textures()
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "hash.hpp"
+
 namespace kynetic
 {
 
@@ -13,17 +15,17 @@ class ResourceManager
     friend class Renderer;
     friend class Scene;
 
-    std::unordered_map<size_t, std::shared_ptr<Resource>> m_resources;
+    // Declared first so it outlives the meshes below, they return their ranges on destruction.
+    std::unique_ptr<class GeometryArena> m_geometry;
 
-    std::vector<std::shared_ptr<class Texture>> m_default_textures;
+    std::unordered_map<size_t, std::shared_ptr<Resource>> m_resources;
 
-    AllocatedBuffer m_merged_index_buffer;
-    AllocatedBuffer m_merged_position_buffer;
-    AllocatedBuffer m_merged_vertex_buffer;
+    // Content key to resource id, and paths that resolved to a resource loaded under another path with the same content.
+    // Aliases stay out of m_resources, so for_each still visits every resource once.
+    std::unordered_map<uint64_t, size_t> m_content_ids;
+    std::unordered_map<size_t, size_t> m_aliases;
 
-    VkDeviceAddress m_merged_index_buffer_address;
-    VkDeviceAddress m_merged_position_buffer_address;
-    VkDeviceAddress m_merged_vertex_buffer_address;
+    std::vector<std::shared_ptr<class Texture>> m_default_textures;
 
     AllocatedBuffer m_material_buffer;
     VkDeviceAddress m_material_buffer_address;
@@ -37,9 +39,16 @@ public:
     ResourceManager& operator=(const ResourceManager&) = delete;
     ResourceManager& operator=(ResourceManager&&) = delete;
 
+    [[nodiscard]] GeometryArena& geometry() const { return *m_geometry; }
+
     template <typename T, typename... Args>
     std::shared_ptr<T> load(const std::filesystem::path& path, Args&&... args);
 
+    // Like load, but returns the resource of the same type that was already built from content_key if there is one, path
+    // then becomes an alias for it. content_key has to cover everything the resource is built from.
+    template <typename T, typename... Args>
+    std::shared_ptr<T> load_unique(const std::filesystem::path& path, uint64_t content_key, Args&&... args);
+
     template <typename T>
     std::shared_ptr<T> find(const std::filesystem::path& path);
 
@@ -52,7 +61,6 @@ public:
         }
     }
 
-    void refresh_mesh_buffers();
     void refresh_material_buffer();
     void refresh_bindless_textures();
 };
@@ -69,10 +77,29 @@ std::shared_ptr<T> ResourceManager::load(const std::filesystem::path& path, Args
     return std::dynamic_pointer_cast<T>(m_resources[id]);
 }
 
+template <typename T, typename... Args>
+std::shared_ptr<T> ResourceManager::load_unique(const std::filesystem::path& path, uint64_t content_key, Args&&... args)
+{
+    if (auto resource = find<T>(path)) return resource;
+    if constexpr (!DEDUPLICATE_RESOURCES) return load<T>(path, std::forward<Args>(args)...);
+
+    const uint64_t key = hash_combine(content_key, typeid(T).hash_code());
+    if (const auto it = m_content_ids.find(key); it != m_content_ids.end())
+    {
+        m_aliases[std::hash<std::string>()(path.string())] = it->second;
+        return std::dynamic_pointer_cast<T>(m_resources[it->second]);
+    }
+
+    std::shared_ptr<T> resource = load<T>(path, std::forward<Args>(args)...);
+    m_content_ids[key] = resource->id;
+    return resource;
+}
+
 template <typename T>
 std::shared_ptr<T> ResourceManager::find(const std::filesystem::path& path)
 {
-    const auto id = std::hash<std::string>()(path.string());
+    auto id = std::hash<std::string>()(path.string());
+    if (const auto it = m_aliases.find(id); it != m_aliases.end()) id = it->second;
     if (const auto it = m_resources.find(id); it != m_resources.end()) return std::dynamic_pointer_cast<T>(it->second);
     return std::shared_ptr<T>();
 }
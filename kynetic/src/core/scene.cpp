@@ -7,6 +7,7 @@
 #include "resource_manager.hpp"
 #include "components.hpp"
 
+#include "rendering/geometry_arena.hpp"
 #include "rendering/shader.hpp"
 #include "rendering/pipeline.hpp"
 #include "rendering/material.hpp"
@@ -17,6 +18,86 @@
 
 using namespace kynetic;
 
+// Granularity at which scene data is compared against the previous upload of the same frame.
+constexpr size_t DELTA_BLOCK_SIZE = 256;
+
+// Per-frame data lives in device local memory the CPU writes through a persistent mapping when the hardware exposes it
+// (resizable BAR), and in plain device local memory filled from staging when it doesn't.
+constexpr VmaAllocationCreateFlags DIRECT_WRITE_FLAGS =
+    VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT;
+
+// Grows buffer geometrically to hold at least size bytes, the old one is released through the frame's deletion queue.
+static void reserve_buffer(PersistentBuffer& buffer,
+                           size_t size,
+                           VkBufferUsageFlags usage,
+                           VmaMemoryUsage memory_usage,
+                           VmaAllocationCreateFlags flags = 0)
+{
+    if (size <= buffer.capacity) return;
+
+    Device& device = Engine::get().device();
+    Context& ctx = device.get_context();
+
+    if (buffer.buffer.buffer != VK_NULL_HANDLE)
+    {
+        const AllocatedBuffer old_buffer = buffer.buffer;
+        ctx.deletion_queue.push_function([=, &device] { device.destroy_buffer(old_buffer); });
+    }
+
+    buffer.capacity = std::max(size, buffer.capacity * 2);
+    buffer.buffer = device.create_buffer(buffer.capacity, usage, memory_usage, flags);
+    buffer.contents.clear();
+
+    if (usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT)
+    {
+        const VkBufferDeviceAddressInfo device_address_info{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+                                                            .buffer = buffer.buffer.buffer};
+        buffer.address = vkGetBufferDeviceAddress(device.get(), &device_address_info);
+    }
+}
+
+// Writes the blocks of data that differ from what target last received, straight into target when it is mapped and into
+// staging otherwise, filling copies with the coalesced staging ranges.
+static void stage_changes(PersistentBuffer& target,
+                          const void* data,
+                          size_t size,
+                          char* staging,
+                          size_t& staging_offset,
+                          std::vector<VkBufferCopy>& copies)
+{
+    copies.clear();
+
+    const char* bytes = static_cast<const char*>(data);
+    char* mapped = static_cast<char*>(target.buffer.info.pMappedData);
+    const size_t uploaded_size = std::min(size, target.contents.size());
+    target.contents.resize(size);
+
+    for (size_t offset = 0; offset < size; offset += DELTA_BLOCK_SIZE)
+    {
+        const size_t block_size = std::min(DELTA_BLOCK_SIZE, size - offset);
+        uint8_t* uploaded = target.contents.data() + offset;
+
+        if (offset + block_size <= uploaded_size && memcmp(uploaded, bytes + offset, block_size) == 0) continue;
+
+        memcpy(uploaded, bytes + offset, block_size);
+
+        if (mapped)
+        {
+            memcpy(mapped + offset, bytes + offset, block_size);
+            continue;
+        }
+
+        memcpy(staging + staging_offset, bytes + offset, block_size);
+
+        if (!copies.empty() && copies.back().dstOffset + copies.back().size == offset)
+            copies.back().size += block_size;
+        else
+            copies.push_back({.srcOffset = staging_offset, .dstOffset = offset, .size = block_size});
+
+        staging_offset += block_size;
+    }
+}
+
 static void get_frustum_planes(glm::mat4x4& view_projection, glm::vec4* out)
 {
     for (auto i = 0; i < 3; ++i)
@@ -87,7 +168,22 @@ Scene::Scene()
         std::make_unique<Pipeline>(ComputePipelineBuilder().set_shader(m_mesh_cull_shader).build(Engine::get().device()));
 }
 
-Scene::~Scene() = default;
+Scene::~Scene()
+{
+    Device& device = Engine::get().device();
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        for (const PersistentBuffer* buffer : {&m_instances_buffers[i],
+                                               &m_instances_output_buffers[i],
+                                               &m_draw_buffers[i],
+                                               &m_mesh_draw_data_buffers[i],
+                                               &m_mesh_indirect_buffers[i],
+                                               &m_scene_buffers[i],
+                                               &m_staging_buffers[i]})
+            if (buffer->buffer.buffer != VK_NULL_HANDLE) device.destroy_buffer(buffer->buffer);
+    }
+}
 
 void Scene::gpu_cull() const
 {
@@ -293,6 +389,7 @@ void Scene::update()
     if (!m_debug_settings.pause_culling) m_previous_vp = vp;
 
     m_draws.clear();
+    m_draw_index_types.clear();
     m_mesh_draw_data.clear();
     m_mesh_indirect_commands.clear();
     m_instances.clear();
@@ -327,6 +424,7 @@ void Scene::update()
                         }
                         else
                         {
+                            m_draw_index_types.push_back(m.mesh->get_index_type());
                             VkDrawIndexedIndirectCommand& draw = m_draws.emplace_back();
                             draw.firstIndex = m.mesh->get_index_offset();
                             draw.indexCount = m.mesh->get_index_count();
@@ -356,6 +454,7 @@ void Scene::update()
                     }
                     else
                     {
+                        m_draw_index_types.push_back(m.mesh->get_index_type());
                         VkDrawIndexedIndirectCommand& draw = m_draws.emplace_back();
                         draw.firstIndex = m.mesh->get_index_offset();
                         draw.indexCount = m.mesh->get_index_count();
@@ -387,10 +486,13 @@ void Scene::update()
                 draw_data.meshlets = m.mesh->get_meshlet_buffer_address();
                 draw_data.meshlet_vertices = m.mesh->get_meshlet_vertices_buffer_address();
                 draw_data.meshlet_triangles = m.mesh->get_meshlet_triangles_buffer_address();
-                draw_data.lod_groups = m.mesh->get_lod_groups_buffer_address();
+                draw_data.clusters = m.mesh->get_cluster_buffer_address();
+                draw_data.meshlet_positions = m.mesh->get_meshlet_positions_buffer_address();
+                draw_data.position_step = m.mesh->get_position_step();
                 draw_data.instance_index = instance_index;
                 draw_data.meshlet_count = static_cast<uint32_t>(m.mesh->get_meshlet_count());
-                draw_data.lod_group_count = static_cast<uint32_t>(m.mesh->get_lod_group_count());
+                draw_data.bounds_min = m.mesh->get_bounds_min();
+                draw_data.bounds_step = m.mesh->get_bounds_step();
 
                 VkDrawMeshTasksIndirectCommandEXT& indirect_cmd = m_mesh_indirect_commands.emplace_back();
                 indirect_cmd.groupCountX =
@@ -415,6 +517,7 @@ void Scene::update()
                 {
                     if (!m_draws.empty()) current_draw_id++;
 
+                    m_draw_index_types.push_back(m.mesh->get_index_type());
                     VkDrawIndexedIndirectCommand& draw = m_draws.emplace_back();
                     draw.firstIndex = m.mesh->get_index_offset();
                     draw.indexCount = m.mesh->get_index_count();
@@ -429,9 +532,37 @@ void Scene::update()
             });
     }
 
+    sort_draws_by_index_type();
     update_buffers();
 }
 
+void Scene::sort_draws_by_index_type()
+{
+    // 16-bit draws go first, so each merged index buffer is bound once and covers one contiguous range of indirect draws.
+    const auto is_short = [](const VkIndexType type) { return type == VK_INDEX_TYPE_UINT16; };
+    m_short_index_draw_count = static_cast<uint32_t>(std::ranges::count_if(m_draw_index_types, is_short));
+
+    if (std::ranges::is_partitioned(m_draw_index_types, is_short)) return;
+
+    std::vector<uint32_t> order(m_draws.size());
+    for (uint32_t i = 0; i < order.size(); i++) order[i] = i;
+    std::ranges::stable_partition(order, [&](const uint32_t i) { return is_short(m_draw_index_types[i]); });
+
+    std::vector<VkDrawIndexedIndirectCommand> draws(m_draws.size());
+    std::vector<uint32_t> remap(m_draws.size());
+    for (uint32_t i = 0; i < order.size(); i++)
+    {
+        draws[i] = m_draws[order[i]];
+        remap[order[i]] = i;
+    }
+    m_draws = std::move(draws);
+    std::ranges::stable_partition(m_draw_index_types, is_short);
+
+    // Draws own their instances through firstInstance, only the GPU culling pass looks draws up by id.
+    if (m_debug_settings.render_mode == RenderMode::GpuDriven)
+        for (InstanceData& instance : m_instances) instance.draw_id = remap[instance.draw_id];
+}
+
 void Scene::update_buffers()
 {
     Device& device = Engine::get().device();
@@ -446,157 +577,82 @@ void Scene::update_buffers()
 
     uint32_t frame_index = device.get_frame_index();
 
-    auto& instances_buffer = m_instances_buffers[frame_index];
-    auto& instances_output_buffer = m_instances_output_buffers[frame_index];
-
-    auto& draw_buffer = m_draw_buffers[frame_index];
-    auto& mesh_draw_data_buffer = m_mesh_draw_data_buffers[frame_index];
-    auto& mesh_indirect_buffer = m_mesh_indirect_buffers[frame_index];
-    auto& scene_buffer = m_scene_buffers[frame_index];
-
-    instances_buffer = device.create_buffer(
-        instance_buffer_size,
-        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-        VMA_MEMORY_USAGE_GPU_ONLY);
-    ctx.deletion_queue.push_function([=, &device] { device.destroy_buffer(instances_buffer); });
-
-    {
-        const VkBufferDeviceAddressInfo device_address_info{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-                                                            .buffer = instances_buffer.buffer};
-        m_instances_buffer_address = vkGetBufferDeviceAddress(device.get(), &device_address_info);
-    }
-
-    instances_output_buffer =
-        device.create_buffer(instance_buffer_size,
-                             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-                             VMA_MEMORY_USAGE_GPU_ONLY);
-    ctx.deletion_queue.push_function([=, &device] { device.destroy_buffer(instances_output_buffer); });
-
-    const VkBufferDeviceAddressInfo addr_info{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-                                              .buffer = instances_output_buffer.buffer};
-    m_instances_output_buffer_address = vkGetBufferDeviceAddress(device.get(), &addr_info);
-
-    if (draw_size > 0)
-    {
-        draw_buffer = device.create_buffer(draw_size,
-                                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
-                                               VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
-                                           VMA_MEMORY_USAGE_GPU_ONLY);
-        ctx.deletion_queue.push_function([=, &device] { device.destroy_buffer(draw_buffer); });
-
-        {
-            const VkBufferDeviceAddressInfo device_address_info{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-                                                                .buffer = draw_buffer.buffer};
-            m_draw_buffer_address = vkGetBufferDeviceAddress(device.get(), &device_address_info);
-        }
-    }
-    if (mesh_draw_data_size > 0)
-    {
-        mesh_draw_data_buffer = device.create_buffer(
-            mesh_draw_data_size,
-            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-            VMA_MEMORY_USAGE_GPU_ONLY);
-        ctx.deletion_queue.push_function([=, &device] { device.destroy_buffer(mesh_draw_data_buffer); });
-
-        {
-            const VkBufferDeviceAddressInfo device_address_info{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-                                                                .buffer = mesh_draw_data_buffer.buffer};
-            m_mesh_draw_data_buffer_address = vkGetBufferDeviceAddress(device.get(), &device_address_info);
-        }
-    }
-
-    if (mesh_indirect_size > 0)
+    PersistentBuffer& instances_buffer = m_instances_buffers[frame_index];
+    PersistentBuffer& instances_output_buffer = m_instances_output_buffers[frame_index];
+
+    PersistentBuffer& draw_buffer = m_draw_buffers[frame_index];
+    PersistentBuffer& mesh_draw_data_buffer = m_mesh_draw_data_buffers[frame_index];
+    PersistentBuffer& mesh_indirect_buffer = m_mesh_indirect_buffers[frame_index];
+    PersistentBuffer& scene_buffer = m_scene_buffers[frame_index];
+    PersistentBuffer& staging = m_staging_buffers[frame_index];
+
+    constexpr VkBufferUsageFlags storage_usage =
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+    reserve_buffer(instances_buffer, instance_buffer_size, storage_usage, VMA_MEMORY_USAGE_AUTO, DIRECT_WRITE_FLAGS);
+    reserve_buffer(instances_output_buffer,
+                   instance_buffer_size,
+                   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                   VMA_MEMORY_USAGE_GPU_ONLY);
+    reserve_buffer(draw_buffer,
+                   draw_size,
+                   storage_usage | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                   VMA_MEMORY_USAGE_AUTO,
+                   DIRECT_WRITE_FLAGS);
+    reserve_buffer(mesh_draw_data_buffer, mesh_draw_data_size, storage_usage, VMA_MEMORY_USAGE_AUTO, DIRECT_WRITE_FLAGS);
+    reserve_buffer(mesh_indirect_buffer,
+                   mesh_indirect_size,
+                   storage_usage | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                   VMA_MEMORY_USAGE_AUTO,
+                   DIRECT_WRITE_FLAGS);
+    reserve_buffer(scene_buffer,
+                   sizeof(SceneData),
+                   VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                   VMA_MEMORY_USAGE_AUTO,
+                   DIRECT_WRITE_FLAGS);
+
+    m_instances_buffer_address = instances_buffer.address;
+    m_instances_output_buffer_address = instances_output_buffer.address;
+    m_draw_buffer_address = draw_buffer.address;
+    m_mesh_draw_data_buffer_address = mesh_draw_data_buffer.address;
+    m_mesh_indirect_buffer_address = mesh_indirect_buffer.address;
+
+    // Only buffers that ended up unmappable need staging, sized for the worst case of every byte of them changing so it never
+    // has to grow halfway through.
+    const auto staged_size = [](const PersistentBuffer& buffer, size_t size)
+    { return buffer.buffer.info.pMappedData ? 0 : size; };
+    const size_t total_staging_size = staged_size(instances_buffer, instance_buffer_size) +
+                                      staged_size(draw_buffer, draw_size) +
+                                      staged_size(mesh_draw_data_buffer, mesh_draw_data_size) +
+                                      staged_size(mesh_indirect_buffer, mesh_indirect_size) +
+                                      staged_size(scene_buffer, sizeof(SceneData));
+    reserve_buffer(staging, total_staging_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY);
+
+    char* staging_data = static_cast<char*>(staging.buffer.info.pMappedData);
+    size_t staging_offset = 0;
+
+    // Culling writes instance and group counts into the draw buffers, so the mirror says nothing about what the GPU holds
+    // and they're rewritten in full. Only CPU owned data takes the delta path.
+    const auto upload = [&](PersistentBuffer& target, const void* data, size_t size, bool gpu_written)
     {
-        mesh_indirect_buffer =
-            device.create_buffer(mesh_indirect_size,
-                                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
-                                     VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
-                                 VMA_MEMORY_USAGE_GPU_ONLY);
-        ctx.deletion_queue.push_function([=, &device] { device.destroy_buffer(mesh_indirect_buffer); });
-
-        {
-            const VkBufferDeviceAddressInfo device_address_info{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-                                                                .buffer = mesh_indirect_buffer.buffer};
-            m_mesh_indirect_buffer_address = vkGetBufferDeviceAddress(device.get(), &device_address_info);
-        }
-    }
-
-    scene_buffer = device.create_buffer(sizeof(SceneData),
-                                        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                                        VMA_MEMORY_USAGE_GPU_ONLY);
-    ctx.deletion_queue.push_function([=, &device] { device.destroy_buffer(scene_buffer); });
-
-    const size_t total_staging_size =
-        instance_buffer_size + draw_size + mesh_draw_data_size + mesh_indirect_size + sizeof(SceneData);
-
-    const AllocatedBuffer staging =
-        device.create_buffer(total_staging_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY);
-    ctx.deletion_queue.push_function([=, &device] { device.destroy_buffer(staging); });
-
-    void* data;
-    vmaMapMemory(device.get_allocator(), staging.allocation, &data);
-
-    size_t offset = 0;
-    memcpy(static_cast<char*>(data) + offset, m_instances.data(), instance_buffer_size);
-    offset += instance_buffer_size;
-
-    memcpy(static_cast<char*>(data) + offset, m_draws.data(), draw_size);
-    offset += draw_size;
-
-    memcpy(static_cast<char*>(data) + offset, m_mesh_draw_data.data(), mesh_draw_data_size);
-    offset += mesh_draw_data_size;
-
-    memcpy(static_cast<char*>(data) + offset, m_mesh_indirect_commands.data(), mesh_indirect_size);
-    offset += mesh_indirect_size;
-
-    memcpy(static_cast<char*>(data) + offset, &m_scene_data, sizeof(SceneData));
-
-    vmaUnmapMemory(device.get_allocator(), staging.allocation);
-
-    size_t src_offset = 0;
-
-    VkBufferCopy instance_copy;
-    instance_copy.dstOffset = 0;
-    instance_copy.srcOffset = src_offset;
-    instance_copy.size = instance_buffer_size;
-    ctx.dcb.copy_buffer(staging.buffer, instances_buffer.buffer, 1, &instance_copy);
-    src_offset += instance_buffer_size;
-
-    if (draw_size > 0)
-    {
-        VkBufferCopy draw_copy;
-        draw_copy.dstOffset = 0;
-        draw_copy.srcOffset = src_offset;
-        draw_copy.size = draw_size;
-        ctx.dcb.copy_buffer(staging.buffer, draw_buffer.buffer, 1, &draw_copy);
-        src_offset += draw_size;
-    }
-
-    if (mesh_draw_data_size > 0)
-    {
-        VkBufferCopy mesh_draw_data_copy;
-        mesh_draw_data_copy.dstOffset = 0;
-        mesh_draw_data_copy.srcOffset = src_offset;
-        mesh_draw_data_copy.size = mesh_draw_data_size;
-        ctx.dcb.copy_buffer(staging.buffer, mesh_draw_data_buffer.buffer, 1, &mesh_draw_data_copy);
-        src_offset += mesh_draw_data_size;
-    }
-
-    if (mesh_indirect_size > 0)
-    {
-        VkBufferCopy mesh_indirect_copy;
-        mesh_indirect_copy.dstOffset = 0;
-        mesh_indirect_copy.srcOffset = src_offset;
-        mesh_indirect_copy.size = mesh_indirect_size;
-        ctx.dcb.copy_buffer(staging.buffer, mesh_indirect_buffer.buffer, 1, &mesh_indirect_copy);
-        src_offset += mesh_indirect_size;
-    }
+        if (size == 0) return;
+        if (gpu_written) target.contents.clear();
+
+        stage_changes(target, data, size, staging_data, staging_offset, m_upload_copies);
+        if (target.buffer.info.pMappedData)
+            VK_CHECK(vmaFlushAllocation(device.get_allocator(), target.buffer.allocation, 0, size));
+        else if (!m_upload_copies.empty())
+            ctx.dcb.copy_buffer(staging.buffer.buffer,
+                                target.buffer.buffer,
+                                static_cast<uint32_t>(m_upload_copies.size()),
+                                m_upload_copies.data());
+    };
 
-    VkBufferCopy scene_data_copy;
-    scene_data_copy.dstOffset = 0;
-    scene_data_copy.srcOffset = src_offset;
-    scene_data_copy.size = sizeof(SceneData);
-    ctx.dcb.copy_buffer(staging.buffer, scene_buffer.buffer, 1, &scene_data_copy);
+    upload(instances_buffer, m_instances.data(), instance_buffer_size, false);
+    upload(draw_buffer, m_draws.data(), draw_size, true);
+    upload(mesh_draw_data_buffer, m_mesh_draw_data.data(), mesh_draw_data_size, false);
+    upload(mesh_indirect_buffer, m_mesh_indirect_commands.data(), mesh_indirect_size, true);
+    upload(scene_buffer, &m_scene_data, sizeof(SceneData), false);
 }
 
 flecs::entity Scene::add_camera(bool is_main_camera) const
@@ -622,8 +678,25 @@ flecs::entity Scene::add_model(const std::shared_ptr<Model>& model) const
         const flecs::entity child_entity = m_scene.entity().child_of(parent).set<TransformComponent>(
             {.translation = node.translation, .rotation = node.rotation, .scale = node.scale});
 
-        for (const auto& mesh : node.meshes)
-            m_scene.entity().child_of(child_entity).add<TransformComponent>().set<MeshComponent>({mesh});
+        if (node.instances.empty())
+        {
+            for (const auto& mesh : node.meshes)
+                m_scene.entity().child_of(child_entity).add<TransformComponent>().set<MeshComponent>({mesh});
+        }
+        else
+        {
+            for (const Model::Instance& instance : node.instances)
+            {
+                for (const auto& mesh : node.meshes)
+                {
+                    m_scene.entity()
+                        .child_of(child_entity)
+                        .set<TransformComponent>(
+                            {.translation = instance.translation, .rotation = instance.rotation, .scale = instance.scale})
+                        .set<MeshComponent>({mesh});
+                }
+            }
+        }
 
         for (const auto& child : node.children) traverse_nodes(child, child_entity);
     };
@@ -638,14 +711,14 @@ AllocatedBuffer Scene::get_instance_buffer() const
     const Device& device = Engine::get().device();
     uint32_t frame_index = device.get_frame_index();
 
-    return m_instances_buffers[frame_index];
+    return m_instances_buffers[frame_index].buffer;
 }
 
 AllocatedBuffer Scene::get_instance_output_buffer() const
 {
     const Device& device = Engine::get().device();
     uint32_t frame_index = device.get_frame_index();
-    return m_instances_output_buffers[frame_index];
+    return m_instances_output_buffers[frame_index].buffer;
 }
 
 AllocatedBuffer Scene::get_draw_buffer() const
@@ -653,7 +726,7 @@ AllocatedBuffer Scene::get_draw_buffer() const
     const Device& device = Engine::get().device();
     uint32_t frame_index = device.get_frame_index();
 
-    return m_draw_buffers[frame_index];
+    return m_draw_buffers[frame_index].buffer;
 }
 
 AllocatedBuffer Scene::get_scene_buffer() const
@@ -661,14 +734,14 @@ AllocatedBuffer Scene::get_scene_buffer() const
     const Device& device = Engine::get().device();
     uint32_t frame_index = device.get_frame_index();
 
-    return m_scene_buffers[frame_index];
+    return m_scene_buffers[frame_index].buffer;
 }
 
 AllocatedBuffer Scene::get_mesh_indirect_buffer() const
 {
     const Device& device = Engine::get().device();
     uint32_t frame_index = device.get_frame_index();
-    return m_mesh_indirect_buffers[frame_index];
+    return m_mesh_indirect_buffers[frame_index].buffer;
 }
 
 void Scene::cull() const
@@ -695,19 +768,44 @@ void Scene::cull() const
 void Scene::draw() const
 {
     Device& device = Engine::get().device();
+    const GeometryArena& geometry = Engine::get().resources().geometry();
     Context& ctx = device.get_context();
 
     switch (m_debug_settings.render_mode)
     {
         case RenderMode::CpuDriven:
         {
-            for (const auto& draw : get_draws())
+            const std::vector<VkDrawIndexedIndirectCommand>& draws = get_draws();
+            for (uint32_t i = 0; i < draws.size(); i++)
+            {
+                if (i == 0 && m_short_index_draw_count > 0)
+                    ctx.dcb.bind_index_buffer(geometry.get_buffer(GeometryPool::ShortIndices), VK_INDEX_TYPE_UINT16);
+                if (i == m_short_index_draw_count)
+                    ctx.dcb.bind_index_buffer(geometry.get_buffer(GeometryPool::Indices), VK_INDEX_TYPE_UINT32);
+
+                const VkDrawIndexedIndirectCommand& draw = draws[i];
                 ctx.dcb.draw(draw.indexCount, draw.instanceCount, draw.firstIndex, draw.vertexOffset, draw.firstInstance);
+            }
         }
         break;
         case RenderMode::GpuDriven:
         {
-            ctx.dcb.multi_draw_indirect(get_draw_buffer().buffer, get_draw_count(), sizeof(VkDrawIndexedIndirectCommand));
+            constexpr uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+            const uint32_t long_index_draw_count = get_draw_count() - m_short_index_draw_count;
+
+            if (m_short_index_draw_count > 0)
+            {
+                ctx.dcb.bind_index_buffer(geometry.get_buffer(GeometryPool::ShortIndices), VK_INDEX_TYPE_UINT16);
+                ctx.dcb.multi_draw_indirect(get_draw_buffer().buffer, m_short_index_draw_count, stride);
+            }
+            if (long_index_draw_count > 0)
+            {
+                ctx.dcb.bind_index_buffer(geometry.get_buffer(GeometryPool::Indices), VK_INDEX_TYPE_UINT32);
+                ctx.dcb.multi_draw_indirect(get_draw_buffer().buffer,
+                                            long_index_draw_count,
+                                            stride,
+                                            static_cast<VkDeviceSize>(m_short_index_draw_count) * stride);
+            }
         }
         break;
         case RenderMode::Meshlets:
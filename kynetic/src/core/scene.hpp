@@ -11,6 +11,16 @@ struct MeshComponent;
 struct CameraComponent;
 struct MainCameraTag;
 
+// Device buffer of one frame in flight that survives across frames, only grows, and mirrors what was last uploaded into
+// it so unchanged ranges are skipped.
+struct PersistentBuffer
+{
+    AllocatedBuffer buffer{VK_NULL_HANDLE};
+    VkDeviceAddress address{0};
+    size_t capacity{0};
+    std::vector<uint8_t> contents;
+};
+
 struct DebugSettings
 {
     bool pause_culling{false};
@@ -61,28 +71,33 @@ class Scene
     std::unique_ptr<Pipeline> m_mesh_cull_pipeline;
 
     std::vector<InstanceData> m_instances;
-    AllocatedBuffer m_instances_buffers[MAX_FRAMES_IN_FLIGHT]{VK_NULL_HANDLE};
+    PersistentBuffer m_instances_buffers[MAX_FRAMES_IN_FLIGHT];
     VkDeviceAddress m_instances_buffer_address{0};
 
     std::vector<VkDrawIndexedIndirectCommand> m_draws;
-    AllocatedBuffer m_draw_buffers[MAX_FRAMES_IN_FLIGHT]{VK_NULL_HANDLE};
+    std::vector<VkIndexType> m_draw_index_types;
+    uint32_t m_short_index_draw_count{0};
+    PersistentBuffer m_draw_buffers[MAX_FRAMES_IN_FLIGHT];
     VkDeviceAddress m_draw_buffer_address{0};
 
     std::vector<MeshDrawData> m_mesh_draw_data;
-    AllocatedBuffer m_mesh_draw_data_buffers[MAX_FRAMES_IN_FLIGHT]{VK_NULL_HANDLE};
+    PersistentBuffer m_mesh_draw_data_buffers[MAX_FRAMES_IN_FLIGHT];
     VkDeviceAddress m_mesh_draw_data_buffer_address{0};
 
     std::vector<VkDrawMeshTasksIndirectCommandEXT> m_mesh_indirect_commands;
-    AllocatedBuffer m_mesh_indirect_buffers[MAX_FRAMES_IN_FLIGHT]{VK_NULL_HANDLE};
-    VkDeviceAddress m_mesh_indirect_buffer_address;
+    PersistentBuffer m_mesh_indirect_buffers[MAX_FRAMES_IN_FLIGHT];
+    VkDeviceAddress m_mesh_indirect_buffer_address{0};
 
     SceneData m_scene_data;
-    AllocatedBuffer m_scene_buffers[MAX_FRAMES_IN_FLIGHT]{VK_NULL_HANDLE};
+    PersistentBuffer m_scene_buffers[MAX_FRAMES_IN_FLIGHT];
     VkDeviceAddress m_scene_buffer_address{0};
 
-    AllocatedBuffer m_instances_output_buffers[MAX_FRAMES_IN_FLIGHT]{VK_NULL_HANDLE};
+    PersistentBuffer m_instances_output_buffers[MAX_FRAMES_IN_FLIGHT];
     VkDeviceAddress m_instances_output_buffer_address{0};
 
+    PersistentBuffer m_staging_buffers[MAX_FRAMES_IN_FLIGHT];
+    std::vector<VkBufferCopy> m_upload_copies;
+
     glm::mat4 m_projection{1.f};
     glm::mat4 m_view{1.f};
     glm::mat4 m_previous_vp = glm::mat4(1.0f);
@@ -95,6 +110,7 @@ class Scene
     void gpu_cull_mesh() const;
 
     void update();
+    void sort_draws_by_index_type();
     void update_buffers();
 
 public:
@@ -0,0 +1,124 @@
+//
+// Created by kenny on 12/2/25.
+//
+
+#include "thread_pool.hpp"
+
+using namespace kynetic;
+
+ThreadPool::ThreadPool(uint32_t thread_count)
+{
+    if (thread_count == 0) thread_count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+    m_workers.reserve(thread_count);
+    for (uint32_t i = 0; i < thread_count; ++i) m_workers.emplace_back([this] { worker_loop(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+
+    for (std::thread& worker : m_workers) worker.join();
+}
+
+void ThreadPool::worker_loop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+
+            if (m_tasks.empty()) return;
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+
+        task();
+    }
+}
+
+bool ThreadPool::try_run_task()
+{
+    std::function<void()> task;
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_tasks.empty()) return false;
+
+        task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+    }
+
+    task();
+    return true;
+}
+
+void ThreadPool::submit(std::function<void()>&& task)
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_condition.notify_one();
+}
+
+void ThreadPool::parallel_for(size_t count, const std::function<void(size_t)>& task)
+{
+    if (count == 0) return;
+
+    if (count == 1 || m_workers.empty())
+    {
+        for (size_t i = 0; i < count; ++i) task(i);
+        return;
+    }
+
+    struct Job
+    {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+    };
+
+    // Helpers can still be queued after the last index finished, the job is shared so they find nothing left to do.
+    auto job = std::make_shared<Job>();
+    const std::function<void(size_t)>* task_ptr = &task;
+
+    auto run = [this, job, task_ptr, count]
+    {
+        size_t index;
+        while ((index = job->next.fetch_add(1)) < count)
+        {
+            (*task_ptr)(index);
+
+            if (job->done.fetch_add(1) + 1 == count)
+            {
+                {
+                    std::lock_guard lock(m_mutex);
+                }
+                m_condition.notify_all();
+            }
+        }
+    };
+
+    const size_t helper_count = std::min(count - 1, m_workers.size());
+    {
+        std::lock_guard lock(m_mutex);
+        for (size_t i = 0; i < helper_count; ++i) m_tasks.emplace_back(run);
+    }
+    m_condition.notify_all();
+
+    run();
+
+    while (job->done.load() < count)
+    {
+        if (try_run_task()) continue;
+
+        std::unique_lock lock(m_mutex);
+        m_condition.wait(lock, [&] { return job->done.load() == count || !m_tasks.empty(); });
+    }
+}
@@ -0,0 +1,46 @@
+//
+// Created by kenny on 12/2/25.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace kynetic
+{
+
+class ThreadPool
+{
+    std::vector<std::thread> m_workers;
+
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+
+    bool m_stopping{false};
+
+    void worker_loop();
+    bool try_run_task();
+
+public:
+    // A thread count of 0 uses every hardware thread, minus the caller which helps out in parallel_for.
+    explicit ThreadPool(uint32_t thread_count = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ThreadPool& operator=(ThreadPool&&) = delete;
+
+    void submit(std::function<void()>&& task);
+
+    // Runs task(i) for every i in [0, count) and returns once all are done. The calling thread takes part and runs other
+    // queued tasks while waiting, so parallel_for can be nested inside pool tasks.
+    void parallel_for(size_t count, const std::function<void(size_t)>& task);
+
+    [[nodiscard]] uint32_t get_thread_count() const { return static_cast<uint32_t>(m_workers.size()) + 1; }
+};
+
+}  // namespace kynetic
@@ -210,6 +210,97 @@ VkPipelineShaderStageCreateInfo vk_init::pipeline_shader_stage_create_info(VkSha
     return info;
 }
 
+void vk_util::generate_mipmaps(VkCommandBuffer cmd, VkImage image, VkExtent2D imageSize)
+{
+    const uint32_t mip_levels = static_cast<uint32_t>(std::floor(std::log2(std::max(imageSize.width, imageSize.height)))) + 1;
+
+    for (uint32_t mip = 0; mip < mip_levels; ++mip)
+    {
+        const VkExtent2D half_size{std::max(imageSize.width / 2, 1u), std::max(imageSize.height / 2, 1u)};
+
+        VkImageSubresourceRange range = vk_init::image_subresource_range(VK_IMAGE_ASPECT_COLOR_BIT);
+        range.baseMipLevel = mip;
+        range.levelCount = 1;
+
+        VkImageMemoryBarrier2 image_barrier{.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+                                            .pNext = nullptr,
+
+                                            .srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                                            .srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT,
+                                            .dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                                            .dstAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT | VK_ACCESS_2_MEMORY_READ_BIT,
+
+                                            .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                            .image = image,
+                                            .subresourceRange = range};
+
+        const VkDependencyInfo dependency_info{.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+                                               .pNext = nullptr,
+                                               .imageMemoryBarrierCount = 1,
+                                               .pImageMemoryBarriers = &image_barrier};
+
+        vkCmdPipelineBarrier2(cmd, &dependency_info);
+
+        if (mip + 1 < mip_levels)
+        {
+            VkImageBlit2 blit_region{.sType = VK_STRUCTURE_TYPE_IMAGE_BLIT_2, .pNext = nullptr};
+
+            blit_region.srcOffsets[1].x = static_cast<int32_t>(imageSize.width);
+            blit_region.srcOffsets[1].y = static_cast<int32_t>(imageSize.height);
+            blit_region.srcOffsets[1].z = 1;
+
+            blit_region.dstOffsets[1].x = static_cast<int32_t>(half_size.width);
+            blit_region.dstOffsets[1].y = static_cast<int32_t>(half_size.height);
+            blit_region.dstOffsets[1].z = 1;
+
+            blit_region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            blit_region.srcSubresource.baseArrayLayer = 0;
+            blit_region.srcSubresource.layerCount = 1;
+            blit_region.srcSubresource.mipLevel = mip;
+
+            blit_region.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            blit_region.dstSubresource.baseArrayLayer = 0;
+            blit_region.dstSubresource.layerCount = 1;
+            blit_region.dstSubresource.mipLevel = mip + 1;
+
+            VkBlitImageInfo2 blit_info{.sType = VK_STRUCTURE_TYPE_BLIT_IMAGE_INFO_2, .pNext = nullptr};
+            blit_info.dstImage = image;
+            blit_info.dstImageLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            blit_info.srcImage = image;
+            blit_info.srcImageLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            blit_info.filter = VK_FILTER_LINEAR;
+            blit_info.regionCount = 1;
+            blit_info.pRegions = &blit_region;
+
+            vkCmdBlitImage2(cmd, &blit_info);
+
+            imageSize = half_size;
+        }
+    }
+
+    // Every level is in TRANSFER_SRC now, move them all to shader reads at once.
+    VkImageMemoryBarrier2 image_barrier{.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+                                        .pNext = nullptr,
+
+                                        .srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                                        .srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT,
+                                        .dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                                        .dstAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT | VK_ACCESS_2_MEMORY_READ_BIT,
+
+                                        .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                        .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                        .image = image,
+                                        .subresourceRange = vk_init::image_subresource_range(VK_IMAGE_ASPECT_COLOR_BIT)};
+
+    const VkDependencyInfo dependency_info{.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+                                           .pNext = nullptr,
+                                           .imageMemoryBarrierCount = 1,
+                                           .pImageMemoryBarriers = &image_barrier};
+
+    vkCmdPipelineBarrier2(cmd, &dependency_info);
+}
+
 VkDescriptorType vk_util::slang_to_vk_descriptor_type(const slang::BindingType type)
 {
     switch (type)
@@ -309,6 +400,22 @@ VkShaderStageFlagBits vk_util::slang_to_vk_stage_bit(const SlangStage stage)
     }
 }
 
+size_t vk_util::get_index_size(const VkIndexType type)
+{
+    switch (type)
+    {
+        case VK_INDEX_TYPE_UINT8_EXT:
+            return sizeof(uint8_t);
+        case VK_INDEX_TYPE_UINT16:
+            return sizeof(uint16_t);
+        case VK_INDEX_TYPE_UINT32:
+            return sizeof(uint32_t);
+        default:
+            KX_ASSERT_MSG(false, "Unknown index type");
+            return 0;
+    }
+}
+
 glm::mat4 make_transform_matrix(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
 {
     glm::mat4 t = glm::translate(glm::mat4(1.0f), position);
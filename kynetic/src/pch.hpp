@@ -142,7 +142,33 @@ constexpr bool USE_VALIDATION_LAYERS = false;
 constexpr uint8_t MAX_FRAMES_IN_FLIGHT = 4;
 constexpr uint8_t MAX_DEPTH_PYRAMID_LEVELS = 10;
 
-constexpr int VERTEX_ATTRIBUTE_COUNT = sizeof(Vertex) / sizeof(float);
+constexpr const char* CACHE_DIRECTORY = "cache";
+
+// Snap mesh positions to a 16-bit grid and give clusters a 6 byte per vertex position stream relative to their bounds.
+constexpr bool QUANTIZE_CLUSTER_POSITIONS = true;
+
+// Let meshes, textures and materials built from identical content share one GPU resource, whatever path loaded them.
+constexpr bool DEDUPLICATE_RESOURCES = true;
+
+// Reorder each mesh's triangles for post-transform cache reuse and overdraw, and its vertices for fetch locality, before
+// the cluster hierarchy is built from them.
+constexpr bool OPTIMIZE_VERTEX_ORDER = true;
+
+// Generate missing tangents with MikkTSpace, or with a faster per triangle accumulation that isn't bit exact with it.
+constexpr bool EXACT_TANGENTS = true;
+
+// Full precision vertex used while importing and simplifying. The attribute weights below index into it, meshes pack it into
+// Vertex once their cluster hierarchy is built.
+struct ImportVertex
+{
+    glm::vec3 normal;
+    float uv_x;
+    glm::vec4 color;
+    glm::vec4 tangent;
+    float uv_y;
+};
+
+constexpr int VERTEX_ATTRIBUTE_COUNT = sizeof(ImportVertex) / sizeof(float);
 
 constexpr float VERTEX_ATTRIBUTE_WEIGHT_NORMAL = 0.5f;
 constexpr float VERTEX_ATTRIBUTE_WEIGHT_UV = 1.0f;
@@ -289,6 +315,8 @@ VkDescriptorType slang_to_vk_descriptor_type(slang::BindingType type);
 
 VkShaderStageFlags slang_to_vk_stage(SlangStage stage);
 VkShaderStageFlagBits slang_to_vk_stage_bit(const SlangStage stage);
+
+size_t get_index_size(VkIndexType type);
 }  // namespace vk_util
 
 glm::mat4 make_transform_matrix(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
@@ -0,0 +1,300 @@
+//
+// Created by kenny on 12/5/25.
+//
+
+#include "asset_file.hpp"
+#include "geometry_codec.hpp"
+
+using namespace kynetic;
+
+constexpr uint32_t ASSET_FILE_MAGIC = 0x5453414b;  // "KAST"
+
+// Keeps every section aligned for its element type, and for block compressed copy offsets.
+constexpr size_t SECTION_ALIGNMENT = 16;
+
+std::filesystem::path asset_file::get_path(uint64_t key)
+{
+    return std::filesystem::path(CACHE_DIRECTORY) / "asset" / fmt::format("{:016x}.kasset", key);
+}
+
+bool asset_file::Reader::contains(const Section& section, size_t alignment) const
+{
+    return section.offset % alignment == 0 && section.offset <= m_data.size() &&
+           section.size <= m_data.size() - section.offset;
+}
+
+bool asset_file::Reader::contains(const String& string) const
+{
+    return static_cast<uint64_t>(string.offset) + string.size <= m_header->strings.size;
+}
+
+bool asset_file::Reader::contains_stream(const Section& section, size_t element_size) const
+{
+    if (!contains(section, alignof(uint32_t))) return false;
+    if (section.size == 0) return true;
+
+    const std::span<const uint8_t> encoded = get<uint8_t>(section);
+    return geometry_codec::validate(encoded) && geometry_codec::get_decoded_size(encoded) % element_size == 0;
+}
+
+uint64_t asset_file::Reader::get_stream_size(const Section& section) const
+{
+    return section.size == 0 ? 0 : geometry_codec::get_decoded_size(get<uint8_t>(section));
+}
+
+bool asset_file::Reader::validate() const
+{
+    if (!contains(m_header->nodes, alignof(NodeRecord)) || !contains(m_header->node_meshes, alignof(uint32_t)) ||
+        !contains(m_header->node_instances, alignof(InstanceRecord)) || !contains(m_header->meshes, alignof(MeshRecord)) ||
+        !contains(m_header->materials, alignof(MaterialRecord)) || !contains(m_header->textures, alignof(TextureRecord)) ||
+        !contains(m_header->levels, alignof(TextureLevel)) || !contains(m_header->strings, 1))
+        return false;
+
+    // Loaders reserve children up front and keep pointers to them, so the counts have to be exact.
+    const std::span<const NodeRecord> nodes = get_nodes();
+    std::vector<uint32_t> child_counts(nodes.size(), 0);
+    for (uint32_t i = 0; i < nodes.size(); ++i)
+    {
+        if (static_cast<uint64_t>(nodes[i].first_mesh) + nodes[i].mesh_count > get_node_meshes().size()) return false;
+        if (static_cast<uint64_t>(nodes[i].first_instance) + nodes[i].instance_count > get_node_instances().size())
+            return false;
+
+        if (nodes[i].parent == NO_PARENT) continue;
+        if (nodes[i].parent >= i || ++child_counts[nodes[i].parent] > nodes[nodes[i].parent].child_count) return false;
+    }
+    for (uint32_t i = 0; i < nodes.size(); ++i)
+        if (child_counts[i] != nodes[i].child_count) return false;
+
+    for (const uint32_t mesh : get_node_meshes())
+        if (mesh >= get_meshes().size()) return false;
+
+    for (const MeshRecord& mesh : get_meshes())
+    {
+        if (!contains(mesh.path) || mesh.material >= get_materials().size()) return false;
+
+        if (!contains_stream(mesh.indices, sizeof(uint32_t)) || !contains_stream(mesh.short_indices, sizeof(uint16_t)) ||
+            !contains_stream(mesh.positions, sizeof(glm::vec3)) || !contains_stream(mesh.vertices, sizeof(Vertex)) ||
+            !contains(mesh.meshlets, alignof(MeshletData)) || !contains(mesh.clusters, alignof(ClusterData)) ||
+            !contains_stream(mesh.meshlet_vertices, sizeof(uint16_t)) ||
+            !contains_stream(mesh.meshlet_triangles, sizeof(uint16_t)) ||
+            !contains_stream(mesh.meshlet_positions, sizeof(uint16_t)))
+            return false;
+
+        // The mesh shader fetches the packed streams as whole words, every meshlet has to stay inside them.
+        const uint64_t vertex_slots = get_stream_size(mesh.meshlet_vertices) / sizeof(uint16_t);
+        const uint64_t triangle_slots = get_stream_size(mesh.meshlet_triangles) / sizeof(uint16_t);
+        const uint64_t position_slots = get_stream_size(mesh.meshlet_positions) / sizeof(uint16_t);
+        if (vertex_slots % 2 != 0 || triangle_slots % 2 != 0 || position_slots % 2 != 0) return false;
+
+        // The amplification shader indexes both per cluster streams with the same meshlet index.
+        if (mesh.clusters.size / sizeof(ClusterData) != mesh.meshlets.size / sizeof(MeshletData)) return false;
+
+        for (const MeshletData& meshlet : get<MeshletData>(mesh.meshlets))
+        {
+            const uint64_t index_slots = meshlet.vertex_index_bits == 32 ? meshlet.vertex_count * 2ull : meshlet.vertex_count;
+            if ((meshlet.vertex_index_bits != 16 && meshlet.vertex_index_bits != 32) ||
+                (meshlet.vertex_index_bits == 32 && meshlet.index_offset % 2 != 0) ||
+                meshlet.index_offset + index_slots > vertex_slots ||
+                static_cast<uint64_t>(meshlet.triangle_offset) + meshlet.triangle_count > triangle_slots)
+                return false;
+
+            const uint64_t last_position = (static_cast<uint64_t>(meshlet.vertex_offset) + meshlet.vertex_count) * 3;
+            if (position_slots != 0 && last_position >= position_slots) return false;
+        }
+    }
+
+    for (const MaterialRecord& material : get_materials())
+    {
+        if (!contains(material.path) || !contains(material.albedo) || !contains(material.normal) ||
+            !contains(material.metal_roughness) || !contains(material.emissive))
+            return false;
+    }
+
+    for (const TextureRecord& texture : get_textures())
+    {
+        if (!contains(texture.path) || !contains(texture.pixels, SECTION_ALIGNMENT) ||
+            static_cast<uint64_t>(texture.first_level) + texture.level_count > get_levels().size())
+            return false;
+
+        for (const TextureLevel& level : get_levels().subspan(texture.first_level, texture.level_count))
+            if (level.offset > texture.pixels.size || level.size > texture.pixels.size - level.offset) return false;
+    }
+
+    return true;
+}
+
+bool asset_file::Reader::open(uint64_t key, std::span<const uint8_t> data, std::string_view name)
+{
+    if (data.size() < sizeof(Header)) return false;
+
+    m_data = data;
+    m_header = reinterpret_cast<const Header*>(m_data.data());
+    const bool current = m_header->magic == ASSET_FILE_MAGIC && m_header->version == VERSION && m_header->key == key;
+    if (current && validate()) return true;
+
+    if (current) fmt::print(stderr, "Asset file '{}' is corrupt, reimporting\n", name);
+
+    m_file = {};
+    m_memory = {};
+    m_data = {};
+    m_header = nullptr;
+    return false;
+}
+
+bool asset_file::Reader::open(uint64_t key)
+{
+    const std::filesystem::path path = get_path(key);
+
+    m_file = MappedFile(path);
+    if (!m_file.is_open()) return false;
+
+    return open(key, {m_file.data(), m_file.size()}, path.string());
+}
+
+bool asset_file::Reader::open(uint64_t key, std::vector<uint8_t>&& memory)
+{
+    m_memory = std::move(memory);
+    return open(key, m_memory, "<memory>");
+}
+
+std::string_view asset_file::Reader::get(const String& string) const
+{
+    return {reinterpret_cast<const char*>(m_data.data() + m_header->strings.offset + string.offset), string.size};
+}
+
+asset_file::Writer::Writer(uint64_t key, std::vector<uint8_t>* memory) : m_path(get_path(key)), m_memory(memory), m_key(key)
+{
+    if (m_memory)
+    {
+        m_memory->assign(sizeof(Header), 0);
+        m_offset = sizeof(Header);
+        return;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(m_path.parent_path(), error);
+    if (error)
+    {
+        fmt::print(stderr, "Failed to create asset directory '{}': {}\n", m_path.parent_path().string(), error.message());
+        return;
+    }
+
+    // Write to a temporary file first so a crash mid-write never leaves a valid looking file behind.
+    m_temp_path = m_path;
+    m_temp_path += fmt::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+    m_file.open(m_temp_path, std::ios::binary | std::ios::trunc);
+
+    // The header is only known once everything else is written, reserve its space for now.
+    const Header header{};
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_offset = sizeof(header);
+}
+
+asset_file::Writer::~Writer()
+{
+    if (m_file.is_open()) discard();
+}
+
+void asset_file::Writer::append(const void* data, size_t size)
+{
+    if (m_memory)
+    {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        m_memory->insert(m_memory->end(), bytes, bytes + size);
+    }
+    else
+    {
+        m_file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    }
+}
+
+void asset_file::Writer::pad()
+{
+    constexpr char zeros[SECTION_ALIGNMENT]{};
+
+    const uint64_t aligned = (m_offset + SECTION_ALIGNMENT - 1) & ~static_cast<uint64_t>(SECTION_ALIGNMENT - 1);
+    append(zeros, aligned - m_offset);
+    m_offset = aligned;
+}
+
+asset_file::Section asset_file::Writer::write(const void* data, size_t size)
+{
+    if (!is_open()) return {};
+
+    pad();
+
+    const Section section{m_offset, size};
+    append(data, size);
+    m_offset += size;
+
+    return section;
+}
+
+asset_file::String asset_file::Writer::add_string(std::string_view string)
+{
+    const String result{static_cast<uint32_t>(m_strings.size()), static_cast<uint32_t>(string.size())};
+    m_strings += string;
+    return result;
+}
+
+bool asset_file::Writer::finish(std::span<const NodeRecord> nodes,
+                                std::span<const uint32_t> node_meshes,
+                                std::span<const InstanceRecord> node_instances,
+                                std::span<const MeshRecord> meshes,
+                                std::span<const MaterialRecord> materials,
+                                std::span<const TextureRecord> textures,
+                                std::span<const TextureLevel> levels)
+{
+    if (!is_open()) return false;
+
+    Header header{};
+    header.magic = ASSET_FILE_MAGIC;
+    header.version = VERSION;
+    header.key = m_key;
+    header.nodes = write(nodes);
+    header.node_meshes = write(node_meshes);
+    header.node_instances = write(node_instances);
+    header.meshes = write(meshes);
+    header.materials = write(materials);
+    header.textures = write(textures);
+    header.levels = write(levels);
+    header.strings = write(m_strings.data(), m_strings.size());
+
+    if (m_memory)
+    {
+        memcpy(m_memory->data(), &header, sizeof(header));
+        return true;
+    }
+
+    m_file.seekp(0);
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    const bool written = m_file.good();
+    m_file.close();
+
+    std::error_code error;
+    if (!written)
+    {
+        fmt::print(stderr, "Failed to write asset file '{}'\n", m_path.string());
+        std::filesystem::remove(m_temp_path, error);
+        return false;
+    }
+
+    // Another baker may have moved the same file into place first.
+    std::filesystem::rename(m_temp_path, m_path, error);
+    if (!error) return true;
+
+    std::filesystem::remove(m_temp_path, error);
+    return std::filesystem::exists(m_path, error);
+}
+
+void asset_file::Writer::discard()
+{
+    if (!m_file.is_open()) return;
+
+    m_file.close();
+
+    std::error_code error;
+    std::filesystem::remove(m_temp_path, error);
+}
@@ -0,0 +1,235 @@
+//
+// Created by kenny on 12/5/25.
+//
+
+#pragma once
+
+#include "texture.hpp"
+
+#include "core/mapped_file.hpp"
+
+#include <fstream>
+
+namespace kynetic
+{
+
+// Baked model container (.kasset). One file per model holding the node hierarchy, materials and every mesh and texture
+// section in the exact layout the GPU buffers and images expect, so loading is a memory map plus staging copies.
+//
+// Layout: Header, 16 byte aligned data sections, then the record tables the header points at.
+namespace asset_file
+{
+
+// Bump whenever a record or the file layout changes, old files are then ignored.
+constexpr uint32_t VERSION = 11;
+
+constexpr uint32_t NO_PARENT = ~0u;
+
+struct Section
+{
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct String
+{
+    uint32_t offset;
+    uint32_t size;
+};
+
+// Nodes are stored depth first, so a parent always comes before its children.
+struct NodeRecord
+{
+    glm::vec3 translation;
+    glm::quat rotation;
+    glm::vec3 scale;
+
+    uint32_t parent;
+    uint32_t child_count;
+
+    // Range in the node mesh table, which holds indices into the mesh records.
+    uint32_t first_mesh;
+    uint32_t mesh_count;
+
+    // Range in the node instance table. When empty the meshes are placed once, at the node itself.
+    uint32_t first_instance;
+    uint32_t instance_count;
+};
+
+// EXT_mesh_gpu_instancing transform, relative to the node.
+struct InstanceRecord
+{
+    glm::vec3 translation;
+    glm::quat rotation;
+    glm::vec3 scale;
+};
+
+struct MeshRecord
+{
+    String path;
+    uint32_t mesh_index;
+    uint32_t material;
+
+    // Hash of the imported geometry, meshes with the same key share their sections.
+    uint64_t content_key;
+
+    uint32_t max_lod_level;
+    float radius;
+    glm::vec3 centroid;
+    float position_step;
+
+    glm::vec3 bounds_min;
+    float bounds_step;
+
+    // Everything but clusters and meshlets is a geometry_codec stream, the loader reads the meshlets to validate them.
+    Section indices;
+    Section short_indices;
+    Section positions;
+    Section vertices;
+    Section clusters;
+    Section meshlets;
+    Section meshlet_vertices;
+    Section meshlet_triangles;
+    Section meshlet_positions;
+};
+
+struct MaterialRecord
+{
+    String path;
+
+    String albedo;
+    String normal;
+    String metal_roughness;
+    String emissive;
+};
+
+struct TextureRecord
+{
+    String path;
+    uint64_t content_key;
+
+    VkFormat format;
+    VkComponentMapping swizzle;
+    VkExtent3D extent;
+
+    VkFilter mag_filter;
+    VkFilter min_filter;
+    VkSamplerMipmapMode mipmap_mode;
+
+    // Range in the level table, level offsets are relative to pixels.
+    uint32_t first_level;
+    uint32_t level_count;
+    Section pixels;
+};
+
+struct Header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+
+    Section nodes;
+    Section node_meshes;
+    Section node_instances;
+    Section meshes;
+    Section materials;
+    Section textures;
+    Section levels;
+    Section strings;
+};
+
+std::filesystem::path get_path(uint64_t key);
+
+class Reader
+{
+    MappedFile m_file;
+    std::vector<uint8_t> m_memory;
+    std::span<const uint8_t> m_data;
+    const Header* m_header{nullptr};
+
+    [[nodiscard]] bool contains(const Section& section, size_t alignment) const;
+    [[nodiscard]] bool contains(const String& string) const;
+    // Geometry sections hold geometry_codec streams, whose decoded size has to be whole elements.
+    [[nodiscard]] bool contains_stream(const Section& section, size_t element_size) const;
+    [[nodiscard]] uint64_t get_stream_size(const Section& section) const;
+    [[nodiscard]] bool validate() const;
+    bool open(uint64_t key, std::span<const uint8_t> data, std::string_view name);
+
+public:
+    // Maps the file for key and checks that every section lies inside it, returns false if there is no usable file.
+    bool open(uint64_t key);
+    // Same checks for an asset a Writer baked into memory, the reader keeps the bytes.
+    bool open(uint64_t key, std::vector<uint8_t>&& memory);
+
+    template <typename T>
+    [[nodiscard]] std::span<const T> get(const Section& section) const
+    {
+        return {reinterpret_cast<const T*>(m_data.data() + section.offset), section.size / sizeof(T)};
+    }
+
+    [[nodiscard]] std::string_view get(const String& string) const;
+
+    [[nodiscard]] std::span<const NodeRecord> get_nodes() const { return get<NodeRecord>(m_header->nodes); }
+    [[nodiscard]] std::span<const uint32_t> get_node_meshes() const { return get<uint32_t>(m_header->node_meshes); }
+    [[nodiscard]] std::span<const InstanceRecord> get_node_instances() const
+    {
+        return get<InstanceRecord>(m_header->node_instances);
+    }
+    [[nodiscard]] std::span<const MeshRecord> get_meshes() const { return get<MeshRecord>(m_header->meshes); }
+    [[nodiscard]] std::span<const MaterialRecord> get_materials() const { return get<MaterialRecord>(m_header->materials); }
+    [[nodiscard]] std::span<const TextureRecord> get_textures() const { return get<TextureRecord>(m_header->textures); }
+    [[nodiscard]] std::span<const TextureLevel> get_levels() const { return get<TextureLevel>(m_header->levels); }
+};
+
+// Streams sections to a temporary file as they're produced, finish writes the record tables and moves the file into place.
+// Given memory, the same file is built up in there instead and never touches the cache.
+class Writer
+{
+    std::filesystem::path m_path;
+    std::filesystem::path m_temp_path;
+    std::ofstream m_file;
+    std::vector<uint8_t>* m_memory{nullptr};
+
+    uint64_t m_key;
+    uint64_t m_offset{0};
+    std::string m_strings;
+
+    void pad();
+    void append(const void* data, size_t size);
+    [[nodiscard]] bool is_open() const { return m_memory != nullptr || m_file.is_open(); }
+
+public:
+    explicit Writer(uint64_t key, std::vector<uint8_t>* memory = nullptr);
+    ~Writer();
+
+    Writer(const Writer&) = delete;
+    Writer(Writer&&) = delete;
+    Writer& operator=(const Writer&) = delete;
+    Writer& operator=(Writer&&) = delete;
+
+    Section write(const void* data, size_t size);
+
+    template <typename T>
+    Section write(std::span<const T> data)
+    {
+        return write(data.data(), data.size_bytes());
+    }
+
+    String add_string(std::string_view string);
+
+    // Returns whether the file is in place.
+    bool finish(std::span<const NodeRecord> nodes,
+                std::span<const uint32_t> node_meshes,
+                std::span<const InstanceRecord> node_instances,
+                std::span<const MeshRecord> meshes,
+                std::span<const MaterialRecord> materials,
+                std::span<const TextureRecord> textures,
+                std::span<const TextureLevel> levels);
+
+    // Drops everything written so far, the destructor does this for writers that never finished.
+    void discard();
+};
+
+}  // namespace asset_file
+
+}  // namespace kynetic
@@ -0,0 +1,162 @@
+//
+// Created by kenny on 12/10/25.
+//
+
+#include "geometry_arena.hpp"
+
+#include "core/device.hpp"
+#include "upload_batch.hpp"
+
+using namespace kynetic;
+
+// First size of every pool, across all of its streams. Pools double from there.
+constexpr VkDeviceSize INITIAL_POOL_SIZE = 32ull * 1024 * 1024;
+
+constexpr VkBufferUsageFlags GEOMETRY_USAGE = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                                              VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                                              VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+GeometryArena::GeometryArena(Device& device) : m_device(device)
+{
+    m_pools[static_cast<size_t>(GeometryPool::Indices)].element_sizes = {sizeof(uint32_t)};
+    m_pools[static_cast<size_t>(GeometryPool::ShortIndices)].element_sizes = {sizeof(uint16_t)};
+    m_pools[static_cast<size_t>(GeometryPool::Vertices)].element_sizes = {sizeof(glm::vec3), sizeof(Vertex)};
+    m_pools[static_cast<size_t>(GeometryPool::Meshlets)].element_sizes = {MESHLET_ELEMENT_SIZE};
+}
+
+GeometryArena::~GeometryArena()
+{
+    for (Pool& pool : m_pools)
+    {
+        for (const AllocatedBuffer& buffer : pool.buffers) m_device.destroy_buffer(buffer);
+        for (const VmaVirtualBlock segment : pool.segments)
+        {
+            vmaClearVirtualBlock(segment);
+            vmaDestroyVirtualBlock(segment);
+        }
+    }
+}
+
+void GeometryArena::grow(Pool& pool, VkDeviceSize count, UploadBatch& uploads)
+{
+    VkDeviceSize stride = 0;
+    for (const uint32_t element_size : pool.element_sizes) stride += element_size;
+
+    const VkDeviceSize old_capacity = pool.capacity;
+    const VkDeviceSize new_capacity = std::max({old_capacity * 2, old_capacity + count, INITIAL_POOL_SIZE / stride});
+
+    std::vector<AllocatedBuffer> old_buffers = std::move(pool.buffers);
+    pool.buffers.clear();
+    pool.addresses.clear();
+
+    for (const uint32_t element_size : pool.element_sizes)
+    {
+        const AllocatedBuffer& buffer = pool.buffers.emplace_back(
+            m_device.create_buffer(new_capacity * element_size, GEOMETRY_USAGE, VMA_MEMORY_USAGE_GPU_ONLY));
+
+        const VkBufferDeviceAddressInfo device_address_info{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+                                                            .buffer = buffer.buffer};
+        pool.addresses.push_back(vkGetBufferDeviceAddress(m_device.get(), &device_address_info));
+    }
+
+    if (!old_buffers.empty())
+    {
+        // Uploads still queued for the old buffers have to land before they're copied over.
+        uploads.flush();
+
+        m_device.uploader().submit(
+            [&](const CommandBuffer& cmd)
+            {
+                for (size_t i = 0; i < old_buffers.size(); i++)
+                {
+                    const VkBufferCopy copy{.srcOffset = 0, .dstOffset = 0, .size = old_capacity * pool.element_sizes[i]};
+                    cmd.copy_buffer(old_buffers[i].buffer, pool.buffers[i].buffer, 1, &copy);
+                }
+            });
+
+        // Frames in flight may still read the old buffers, and the copy above certainly does.
+        for (const AllocatedBuffer& buffer : old_buffers) m_device.retire_buffer(buffer);
+    }
+
+    const VmaVirtualBlockCreateInfo block_create_info{.size = new_capacity - old_capacity};
+    VmaVirtualBlock segment;
+    VK_CHECK(vmaCreateVirtualBlock(&block_create_info, &segment));
+
+    pool.segments.push_back(segment);
+    pool.segment_offsets.push_back(old_capacity);
+    pool.capacity = new_capacity;
+}
+
+GeometryRange GeometryArena::allocate(GeometryPool pool_type, VkDeviceSize count, UploadBatch& uploads)
+{
+    GeometryRange range{.pool = pool_type, .count = count};
+    if (count == 0) return range;
+
+    Pool& pool = m_pools[static_cast<size_t>(pool_type)];
+    const VmaVirtualAllocationCreateInfo allocation_create_info{.size = count};
+
+    for (uint32_t i = 0; i < pool.segments.size(); i++)
+    {
+        VkDeviceSize offset;
+        if (vmaVirtualAllocate(pool.segments[i], &allocation_create_info, &range.allocation, &offset) == VK_SUCCESS)
+        {
+            range.segment = i;
+            range.offset = pool.segment_offsets[i] + offset;
+            return range;
+        }
+    }
+
+    grow(pool, count, uploads);
+
+    VkDeviceSize offset;
+    VK_CHECK(vmaVirtualAllocate(pool.segments.back(), &allocation_create_info, &range.allocation, &offset));
+    range.segment = static_cast<uint32_t>(pool.segments.size() - 1);
+    range.offset = pool.segment_offsets.back() + offset;
+    return range;
+}
+
+void GeometryArena::reserve(GeometryPool pool_type, VkDeviceSize count, UploadBatch& uploads)
+{
+    if (count == 0) return;
+
+    Pool& pool = m_pools[static_cast<size_t>(pool_type)];
+    for (const VmaVirtualBlock segment : pool.segments)
+    {
+        VmaDetailedStatistics statistics;
+        vmaCalculateVirtualBlockStatistics(segment, &statistics);
+        if (statistics.unusedRangeSizeMax >= count) return;
+    }
+
+    grow(pool, count, uploads);
+}
+
+void GeometryArena::free(GeometryRange& range)
+{
+    if (range.allocation == VK_NULL_HANDLE) return;
+
+    vmaVirtualFree(m_pools[static_cast<size_t>(range.pool)].segments[range.segment], range.allocation);
+    range = {};
+}
+
+VkBuffer GeometryArena::get_buffer(GeometryPool pool, uint32_t stream) const
+{
+    const Pool& p = m_pools[static_cast<size_t>(pool)];
+    return p.buffers.empty() ? VK_NULL_HANDLE : p.buffers[stream].buffer;
+}
+
+VkDeviceAddress GeometryArena::get_address(GeometryPool pool, uint32_t stream) const
+{
+    const Pool& p = m_pools[static_cast<size_t>(pool)];
+    return p.addresses.empty() ? 0 : p.addresses[stream];
+}
+
+VkDeviceSize GeometryArena::get_offset(const GeometryRange& range, uint32_t stream) const
+{
+    return range.offset * m_pools[static_cast<size_t>(range.pool)].element_sizes[stream];
+}
+
+VkDeviceAddress GeometryArena::get_address(const GeometryRange& range, uint32_t stream) const
+{
+    if (range.count == 0) return 0;
+    return get_address(range.pool, stream) + get_offset(range, stream);
+}
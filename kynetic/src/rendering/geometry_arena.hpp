@@ -0,0 +1,81 @@
+//
+// Created by kenny on 12/10/25.
+//
+
+#pragma once
+
+namespace kynetic
+{
+
+// Unit of the meshlet pool, every meshlet data stream of a mesh starts on one.
+constexpr uint32_t MESHLET_ELEMENT_SIZE = 16;
+
+// Every pool is one buffer per stream that draws bind or address as a whole. Ranges are counted in elements, so their
+// offsets double as firstIndex, vertexOffset or array index into the pool.
+enum class GeometryPool : uint8_t
+{
+    Indices,
+    ShortIndices,
+    Vertices,  // positions in stream 0 and vertex attributes in stream 1, a range covers both at the same offset
+    Meshlets,  // the meshlet and cluster data of a mesh packed into one range of 16-byte elements
+    Count,
+};
+
+struct GeometryRange
+{
+    VmaVirtualAllocation allocation{VK_NULL_HANDLE};
+    GeometryPool pool{GeometryPool::Count};
+    uint32_t segment{0};
+
+    VkDeviceSize offset{0};
+    VkDeviceSize count{0};
+};
+
+// Sub-allocates all mesh geometry out of a few large buffers, so adding a mesh costs a handful of offset allocations
+// instead of buffers of its own plus a merged copy. Freed ranges are reused, and pools only grow, geometrically with a
+// copy on the GPU, once no free range is large enough.
+class GeometryArena
+{
+    struct Pool
+    {
+        std::vector<uint32_t> element_sizes;
+        std::vector<AllocatedBuffer> buffers;
+        std::vector<VkDeviceAddress> addresses;
+
+        // Growing appends a segment for the new tail, so existing ranges keep their offsets.
+        std::vector<VmaVirtualBlock> segments;
+        std::vector<VkDeviceSize> segment_offsets;
+        VkDeviceSize capacity{0};
+    };
+
+    class Device& m_device;
+    Pool m_pools[static_cast<size_t>(GeometryPool::Count)];
+
+    void grow(Pool& pool, VkDeviceSize count, class UploadBatch& uploads);
+
+public:
+    explicit GeometryArena(Device& device);
+    ~GeometryArena();
+
+    GeometryArena(const GeometryArena&) = delete;
+    GeometryArena(GeometryArena&&) = delete;
+    GeometryArena& operator=(const GeometryArena&) = delete;
+    GeometryArena& operator=(GeometryArena&&) = delete;
+
+    // Takes count elements out of every stream of pool. When no segment has room the pool grows, which flushes uploads
+    // first so nothing queued for the old buffers is lost.
+    GeometryRange allocate(GeometryPool pool, VkDeviceSize count, UploadBatch& uploads);
+    // Grows pool once up front unless count elements already fit in one free range, so that allocations adding up to count
+    // append into reserved space instead of growing the pool one after another.
+    void reserve(GeometryPool pool, VkDeviceSize count, UploadBatch& uploads);
+    void free(GeometryRange& range);
+
+    [[nodiscard]] VkBuffer get_buffer(GeometryPool pool, uint32_t stream = 0) const;
+    [[nodiscard]] VkDeviceAddress get_address(GeometryPool pool, uint32_t stream = 0) const;
+
+    // Byte offset and address of range in the buffer of stream. Growing keeps offsets but moves addresses.
+    [[nodiscard]] VkDeviceSize get_offset(const GeometryRange& range, uint32_t stream = 0) const;
+    [[nodiscard]] VkDeviceAddress get_address(const GeometryRange& range, uint32_t stream = 0) const;
+};
+
+}  // namespace kynetic
@@ -0,0 +1,215 @@
+//
+// Created by kenny on 12/10/25.
+//
+
+#include "geometry_codec.hpp"
+
+#include "core/hash.hpp"
+#include "core/thread_pool.hpp"
+
+#include <atomic>
+
+KX_DISABLE_WARNING_PUSH
+KX_DISABLE_WARNING_SIGNED_UNSIGNED_ASSIGNMENT_MISMATCH
+#include "meshoptimizer.h"
+KX_DISABLE_WARNING_POP
+
+using namespace kynetic;
+
+enum class Codec : uint32_t
+{
+    Vertex,
+    Index,
+};
+
+struct StreamHeader
+{
+    Codec codec;
+    uint32_t stride;
+    uint32_t chunk_count;
+    uint32_t checksum;  // of everything after the header, decoding corrupt chunks can succeed with garbage
+    uint64_t size;
+};
+
+static uint32_t get_chunk_elements(Codec codec)
+{
+    return codec == Codec::Index ? geometry_codec::CHUNK_ELEMENTS * 3 : geometry_codec::CHUNK_ELEMENTS;
+}
+
+static const StreamHeader& get_header(std::span<const uint8_t> encoded)
+{
+    return *reinterpret_cast<const StreamHeader*>(encoded.data());
+}
+
+static const uint32_t* get_chunk_offsets(std::span<const uint8_t> encoded)
+{
+    return reinterpret_cast<const uint32_t*>(encoded.data() + sizeof(StreamHeader));
+}
+
+static uint32_t get_checksum(std::span<const uint8_t> encoded)
+{
+    return static_cast<uint32_t>(hash_span(encoded.subspan(sizeof(StreamHeader))));
+}
+
+static const uint8_t* get_chunk_data(std::span<const uint8_t> encoded)
+{
+    return encoded.data() + sizeof(StreamHeader) + (get_header(encoded).chunk_count + 1) * sizeof(uint32_t);
+}
+
+// Chunks are encoded on their own, each into the worst case bound first and trimmed once all are done.
+template <typename EncodeChunk>
+static std::vector<uint8_t> encode(Codec codec, size_t size, size_t stride, size_t chunk_bound, EncodeChunk&& encode_chunk)
+{
+    const size_t element_count = (size + stride - 1) / stride;
+    const size_t chunk_elements = get_chunk_elements(codec);
+    const size_t chunk_count = (element_count + chunk_elements - 1) / chunk_elements;
+
+    std::vector<std::vector<uint8_t>> chunks(chunk_count);
+    for (size_t i = 0; i < chunk_count; ++i)
+    {
+        const size_t first = i * chunk_elements;
+        const size_t count = std::min(chunk_elements, element_count - first);
+
+        chunks[i].resize(chunk_bound);
+        chunks[i].resize(encode_chunk(chunks[i].data(), chunks[i].size(), first, count));
+    }
+
+    StreamHeader header{};
+    header.codec = codec;
+    header.stride = static_cast<uint32_t>(stride);
+    header.chunk_count = static_cast<uint32_t>(chunk_count);
+    header.size = size;
+
+    std::vector<uint32_t> offsets(chunk_count + 1, 0);
+    for (size_t i = 0; i < chunk_count; ++i) offsets[i + 1] = offsets[i] + static_cast<uint32_t>(chunks[i].size());
+
+    std::vector<uint8_t> encoded(sizeof(StreamHeader) + offsets.size() * sizeof(uint32_t) + offsets.back());
+    memcpy(encoded.data() + sizeof(header), offsets.data(), offsets.size() * sizeof(uint32_t));
+
+    uint8_t* chunk_data = encoded.data() + sizeof(header) + offsets.size() * sizeof(uint32_t);
+    for (size_t i = 0; i < chunk_count; ++i) memcpy(chunk_data + offsets[i], chunks[i].data(), chunks[i].size());
+
+    header.checksum = get_checksum(encoded);
+    memcpy(encoded.data(), &header, sizeof(header));
+
+    return encoded;
+}
+
+std::vector<uint8_t> geometry_codec::encode_vertices(const void* data, size_t size, size_t stride)
+{
+    KX_ASSERT(stride % 4 == 0 && stride <= 256);
+
+    // A partial last element is zero padded, decode drops the padding again.
+    std::vector<uint8_t> padded;
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    if (size % stride != 0)
+    {
+        padded.resize(size + stride - size % stride, 0);
+        memcpy(padded.data(), data, size);
+        bytes = padded.data();
+    }
+
+    return encode(Codec::Vertex,
+                  size,
+                  stride,
+                  meshopt_encodeVertexBufferBound(CHUNK_ELEMENTS, stride),
+                  [&](uint8_t* buffer, size_t buffer_size, size_t first, size_t count)
+                  { return meshopt_encodeVertexBuffer(buffer, buffer_size, bytes + first * stride, count, stride); });
+}
+
+std::vector<uint8_t> geometry_codec::encode_indices(const void* data, size_t size, size_t index_size)
+{
+    KX_ASSERT((index_size == 2 || index_size == 4) && size % (index_size * 3) == 0);
+
+    // The encoder only takes 32-bit indices, the decoder writes either width.
+    std::vector<uint32_t> indices(size / index_size);
+    if (index_size == 2)
+    {
+        const auto* short_indices = static_cast<const uint16_t*>(data);
+        for (size_t i = 0; i < indices.size(); ++i) indices[i] = short_indices[i];
+    }
+    else
+    {
+        memcpy(indices.data(), data, size);
+    }
+
+    const size_t vertex_count = indices.empty() ? 0 : *std::ranges::max_element(indices) + 1;
+
+    return encode(Codec::Index,
+                  size,
+                  index_size,
+                  meshopt_encodeIndexBufferBound(CHUNK_ELEMENTS * 3, vertex_count),
+                  [&](uint8_t* buffer, size_t buffer_size, size_t first, size_t count)
+                  { return meshopt_encodeIndexBuffer(buffer, buffer_size, indices.data() + first, count); });
+}
+
+bool geometry_codec::validate(std::span<const uint8_t> encoded)
+{
+    if (encoded.size() < sizeof(StreamHeader)) return false;
+
+    const StreamHeader& header = get_header(encoded);
+    if (header.codec == Codec::Index ? header.stride != 2 && header.stride != 4 || header.size % (header.stride * 3) != 0
+                                     : header.stride == 0 || header.stride % 4 != 0 || header.stride > 256)
+        return false;
+
+    const uint64_t chunk_elements = get_chunk_elements(header.codec);
+    const uint64_t element_count = (header.size + header.stride - 1) / header.stride;
+    if (header.chunk_count != (element_count + chunk_elements - 1) / chunk_elements) return false;
+
+    const uint64_t table_size = sizeof(StreamHeader) + (static_cast<uint64_t>(header.chunk_count) + 1) * sizeof(uint32_t);
+    if (encoded.size() < table_size) return false;
+
+    const uint32_t* offsets = get_chunk_offsets(encoded);
+    for (uint32_t i = 0; i < header.chunk_count; ++i)
+        if (offsets[i] > offsets[i + 1]) return false;
+
+    return offsets[0] == 0 && table_size + offsets[header.chunk_count] <= encoded.size() &&
+           header.checksum == get_checksum(encoded);
+}
+
+size_t geometry_codec::get_decoded_size(std::span<const uint8_t> encoded) { return get_header(encoded).size; }
+
+GeometryStream geometry_codec::make_stream(std::span<const uint8_t> encoded)
+{
+    GeometryStream stream;
+    stream.size = get_decoded_size(encoded);
+    stream.encoded = encoded;
+    return stream;
+}
+
+bool geometry_codec::decode(std::span<const uint8_t> encoded, void* destination, ThreadPool& threads)
+{
+    const StreamHeader& header = get_header(encoded);
+    const uint32_t* offsets = get_chunk_offsets(encoded);
+    const uint8_t* chunk_data = get_chunk_data(encoded);
+
+    const size_t chunk_elements = get_chunk_elements(header.codec);
+    const size_t element_count = (header.size + header.stride - 1) / header.stride;
+
+    std::atomic<bool> failed{false};
+    threads.parallel_for(header.chunk_count,
+                         [&](size_t chunk)
+                         {
+                             const size_t first = chunk * chunk_elements;
+                             const size_t count = std::min(chunk_elements, element_count - first);
+
+                             uint8_t* output = static_cast<uint8_t*>(destination) + first * header.stride;
+                             const uint8_t* input = chunk_data + offsets[chunk];
+                             const size_t input_size = offsets[chunk + 1] - offsets[chunk];
+
+                             // The chunk holding a padded last element goes through a scratch buffer.
+                             const size_t output_size = std::min(count * header.stride, header.size - first * header.stride);
+                             std::vector<uint8_t> scratch;
+                             if (output_size < count * header.stride) scratch.resize(count * header.stride);
+
+                             uint8_t* target = scratch.empty() ? output : scratch.data();
+                             const int result =
+                                 header.codec == Codec::Index
+                                     ? meshopt_decodeIndexBuffer(target, count, header.stride, input, input_size)
+                                     : meshopt_decodeVertexBuffer(target, count, header.stride, input, input_size);
+                             if (result != 0) failed = true;
+                             else if (!scratch.empty()) memcpy(output, scratch.data(), output_size);
+                         });
+
+    return !failed;
+}
@@ -0,0 +1,71 @@
+//
+// Created by kenny on 12/10/25.
+//
+
+#pragma once
+
+namespace kynetic
+{
+
+class ThreadPool;
+
+// The bytes of one GPU buffer as a Mesh receives them, either plain or as an encoded geometry_codec stream.
+struct GeometryStream
+{
+    const void* data{nullptr};
+    size_t size{0};  // decoded size in bytes
+
+    // Decoded into staging memory on upload instead of copying data, when set.
+    std::span<const uint8_t> encoded;
+
+    GeometryStream() = default;
+
+    template <typename T>
+    GeometryStream(std::span<const T> elements) : data(elements.data()), size(elements.size_bytes())
+    {
+    }
+
+    template <typename T>
+    GeometryStream(const std::vector<T>& elements) : GeometryStream(std::span<const T>(elements))
+    {
+    }
+
+    [[nodiscard]] bool empty() const { return size == 0; }
+
+    template <typename T>
+    [[nodiscard]] size_t count() const
+    {
+        return size / sizeof(T);
+    }
+};
+
+// meshoptimizer's vertex and index codecs, applied to independent chunks so a stream decodes on every thread at once.
+//
+// Layout: StreamHeader, chunk_count + 1 chunk offsets relative to the end of the offset table, then the chunks.
+namespace geometry_codec
+{
+
+// Elements per chunk, index streams chunk whole triangles.
+constexpr uint32_t CHUNK_ELEMENTS = 16 * 1024;
+
+// stride has to be a multiple of four and at most 256, the vertex codec treats each element as one vertex. size doesn't
+// have to be a multiple of stride, so packed 16-bit streams can be encoded two values at a time.
+std::vector<uint8_t> encode_vertices(const void* data, size_t size, size_t stride);
+// index_size is 2 or 4, the index codec expects a triangle list.
+std::vector<uint8_t> encode_indices(const void* data, size_t size, size_t index_size);
+
+// Checks the header and chunk table against the stream's bytes and the checksum over both, so a stream that validates
+// also decodes.
+bool validate(std::span<const uint8_t> encoded);
+
+// Decoded size in bytes of a validated stream.
+size_t get_decoded_size(std::span<const uint8_t> encoded);
+
+GeometryStream make_stream(std::span<const uint8_t> encoded);
+
+// Decodes every chunk of a validated stream in parallel into destination, which has get_decoded_size bytes.
+bool decode(std::span<const uint8_t> encoded, void* destination, ThreadPool& threads);
+
+}  // namespace geometry_codec
+
+}  // namespace kynetic
@@ -6,11 +6,19 @@
 
 #include <utility>
 
+#include "mesh_cache.hpp"
+#include "upload_batch.hpp"
 #include "core/device.hpp"
 #include "core/engine.hpp"
+#include "core/hash.hpp"
+#include "core/resource_manager.hpp"
+#include "core/thread_pool.hpp"
 
 #include "vma_usage.hpp"
+#include "glm/gtc/type_precision.hpp"
+#include "glm/gtx/component_wise.hpp"
 #include "glm/gtx/norm.hpp"
+#include "glm/packing.hpp"
 
 KX_DISABLE_WARNING_PUSH
 KX_DISABLE_WARNING_SIGNED_UNSIGNED_ASSIGNMENT_MISMATCH
@@ -23,60 +31,327 @@ KX_DISABLE_WARNING_POP
 
 using namespace kynetic;
 
-Mesh::Mesh(const std::filesystem::path& path,
-           uint32_t mesh_index,
-           std::span<uint32_t> unindexed_indices,
-           std::span<glm::vec4> unindexed_positions,
-           std::span<Vertex> unindexed_vertices,
-           std::shared_ptr<Material> material)
-    : Resource(Type::Mesh, path.string()),
-      m_mesh_index(mesh_index),
-      m_index_count(static_cast<uint32_t>(unindexed_indices.size())),
-      m_vertex_count(static_cast<uint32_t>(unindexed_vertices.size())),
-      m_material(std::move(material))
-{
-    std::span<glm::vec4>& positions = unindexed_positions;
-    std::span<uint32_t>& indices = unindexed_indices;
+static constexpr unsigned int CLUSTER_ATTRIBUTE_PROTECT_MASK = 1u << 3 | 1u << 12;
 
-    calculate_bounds(unindexed_positions);
+// Cluster spheres are unorm16, the rest of the range is headroom for the radius growth that keeps quantized LOD spheres
+// nested.
+static constexpr float CLUSTER_BOUNDS_STEPS = 65000.f;
 
+// Cluster position offsets are 16 bits per axis, one step is kept in reserve for the rounding of the snapped extent.
+static constexpr float CLUSTER_POSITION_STEPS = 65534.f;
+// Grid coordinates have to survive the float conversion in the mesh shader exactly.
+static constexpr float CLUSTER_POSITION_MAX_GRID = static_cast<float>(1 << 23);
+
+// How much worse than the cache optimal order the overdraw pass may make vertex cache efficiency.
+static constexpr float OVERDRAW_THRESHOLD = 1.05f;
+
+static clodConfig get_cluster_config()
+{
     clodConfig config = clodDefaultConfig(64);
     config.max_vertices = 32;
+    return config;
+}
+
+static uint64_t get_cluster_cache_key(const clodConfig& config,
+                                      float position_step,
+                                      std::span<const uint32_t> indices,
+                                      std::span<const glm::vec3> positions,
+                                      std::span<const ImportVertex> vertices)
+{
+    uint64_t key = hash_combine(mesh_cache::VERSION, sizeof(ImportVertex));
+    key = hash_combine(key, sizeof(ClusterData));
+    key = hash_combine(key, sizeof(MeshletData));
+    key = hash_combine(key, sizeof(LODGroupData));
+
+    key = hash_combine(key, hash_span(indices));
+    key = hash_combine(key, hash_span(positions));
+    key = hash_combine(key, hash_span(vertices));
+
+    // Hashed field by field, clodConfig has padding between its bools.
+    key = hash_combine(key, config.max_vertices);
+    key = hash_combine(key, config.min_triangles);
+    key = hash_combine(key, config.max_triangles);
+    key = hash_combine(key, config.partition_spatial);
+    key = hash_combine(key, config.partition_sort);
+    key = hash_combine(key, config.partition_size);
+    key = hash_combine(key, config.cluster_spatial);
+    key = hash_combine(key, hash_bytes(&config.cluster_fill_weight, sizeof(float)));
+    key = hash_combine(key, hash_bytes(&config.cluster_split_factor, sizeof(float)));
+    key = hash_combine(key, hash_bytes(&config.simplify_ratio, sizeof(float)));
+    key = hash_combine(key, hash_bytes(&config.simplify_threshold, sizeof(float)));
+    key = hash_combine(key, hash_bytes(&config.simplify_error_merge_previous, sizeof(float)));
+    key = hash_combine(key, hash_bytes(&config.simplify_error_merge_additive, sizeof(float)));
+    key = hash_combine(key, hash_bytes(&config.simplify_error_factor_sloppy, sizeof(float)));
+    key = hash_combine(key, hash_bytes(&config.simplify_error_edge_limit, sizeof(float)));
+    key = hash_combine(key, config.simplify_permissive);
+    key = hash_combine(key, config.simplify_fallback_permissive);
+    key = hash_combine(key, config.simplify_fallback_sloppy);
+    key = hash_combine(key, config.simplify_regularize);
+    key = hash_combine(key, config.optimize_bounds);
+    key = hash_combine(key, config.optimize_clusters);
+
+    key = hash_combine(key, hash_bytes(VERTEX_ATTRIBUTE_WEIGHTS, sizeof(VERTEX_ATTRIBUTE_WEIGHTS)));
+    key = hash_combine(key, CLUSTER_ATTRIBUTE_PROTECT_MASK);
+    key = hash_combine(key, hash_bytes(&position_step, sizeof(float)));
+
+    return key;
+}
+
+// Returns the power of two grid step that fits the mesh extent into CLUSTER_POSITION_STEPS, or 0 when the mesh is degenerate or
+// too far from its origin for the grid coordinates to stay exact.
+static float get_position_step(std::span<const glm::vec3> positions)
+{
+    if (positions.empty()) return 0.f;
+
+    glm::vec3 min(FLT_MAX), max(-FLT_MAX);
+    for (const auto& p : positions)
+    {
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+    }
+
+    const float extent = glm::compMax(max - min);
+    if (extent <= 0.f) return 0.f;
+
+    const float step = std::exp2(std::ceil(std::log2(extent / CLUSTER_POSITION_STEPS)));
+    if (glm::compMax(glm::max(glm::abs(min), glm::abs(max))) / step > CLUSTER_POSITION_MAX_GRID) return 0.f;
+
+    return step;
+}
+
+static void snap_positions(std::span<glm::vec3> positions, float position_step)
+{
+    for (auto& p : positions) p = glm::round(p / position_step) * position_step;
+}
+
+// Stores each meshlet vertex as three 16-bit offsets from the meshlet's minimum grid coordinate. The stream is parallel to
+// meshlet_vertices and padded so the mesh shader can always fetch the two words covering a vertex.
+static void quantize_cluster_positions(ThreadPool& threads,
+                                       std::span<const glm::vec3> positions,
+                                       std::span<const uint32_t> meshlet_vertices,
+                                       MeshClusterData& data)
+{
+    const float position_step = data.position_step;
+    data.meshlet_positions.assign((meshlet_vertices.size() * 3 + 2) & ~size_t{1}, 0);
+
+    constexpr size_t QUANTIZE_BATCH_SIZE = 256;
+    threads.parallel_for((data.meshlets.size() + QUANTIZE_BATCH_SIZE - 1) / QUANTIZE_BATCH_SIZE,
+                         [&](size_t batch)
+                         {
+                             const size_t end = std::min(data.meshlets.size(), (batch + 1) * QUANTIZE_BATCH_SIZE);
+                             for (size_t m = batch * QUANTIZE_BATCH_SIZE; m < end; ++m)
+                             {
+                                 MeshletData& meshlet = data.meshlets[m];
+                                 const uint32_t* vertices = meshlet_vertices.data() + meshlet.vertex_offset;
+
+                                 glm::ivec3 origin(INT_MAX);
+                                 for (uint32_t v = 0; v < meshlet.vertex_count; ++v)
+                                     origin = glm::min(origin, glm::ivec3(glm::round(positions[vertices[v]] / position_step)));
+
+                                 meshlet.position_origin = meshlet.vertex_count > 0 ? origin : glm::ivec3(0);
+
+                                 uint16_t* out = data.meshlet_positions.data() + meshlet.vertex_offset * 3;
+                                 for (uint32_t v = 0; v < meshlet.vertex_count; ++v)
+                                 {
+                                     const glm::ivec3 offset =
+                                         glm::ivec3(glm::round(positions[vertices[v]] / position_step)) - origin;
+                                     KX_ASSERT(glm::all(glm::lessThanEqual(offset, glm::ivec3(UINT16_MAX))));
+
+                                     out[v * 3 + 0] = static_cast<uint16_t>(offset.x);
+                                     out[v * 3 + 1] = static_cast<uint16_t>(offset.y);
+                                     out[v * 3 + 2] = static_cast<uint16_t>(offset.z);
+                                 }
+                             }
+                         });
+}
+
+// Rewrites the meshlet index lists into their packed GPU form. Vertex indices become 16-bit deltas from the meshlet's
+// smallest index, falling back to word aligned 32-bit indices when the range doesn't fit. Triangles take 16 bits each, three
+// 5-bit local indices, which max_vertices = 32 guarantees to fit.
+static void pack_meshlet_indices(std::span<const uint32_t> meshlet_vertices,
+                                 std::span<const uint8_t> meshlet_triangles,
+                                 MeshClusterData& data)
+{
+    std::vector<uint16_t>& packed_vertices = data.meshlet_vertices;
+    std::vector<uint16_t>& packed_triangles = data.meshlet_triangles;
+
+    packed_vertices.reserve(meshlet_vertices.size() + meshlet_vertices.size() / 8);
+    packed_triangles.reserve(meshlet_triangles.size() / 3 + 1);
+
+    for (MeshletData& meshlet : data.meshlets)
+    {
+        const std::span<const uint32_t> vertices = meshlet_vertices.subspan(meshlet.vertex_offset, meshlet.vertex_count);
+        const auto [min, max] =
+            vertices.empty() ? std::ranges::minmax_result<uint32_t>{0, 0} : std::ranges::minmax(vertices);
+
+        if (max - min <= UINT16_MAX)
+        {
+            meshlet.vertex_index_bits = 16;
+            meshlet.vertex_base = min;
+            meshlet.index_offset = static_cast<uint32_t>(packed_vertices.size());
+            for (const uint32_t v : vertices) packed_vertices.push_back(static_cast<uint16_t>(v - min));
+        }
+        else
+        {
+            if (packed_vertices.size() % 2 != 0) packed_vertices.push_back(0);
+
+            meshlet.vertex_index_bits = 32;
+            meshlet.vertex_base = 0;
+            meshlet.index_offset = static_cast<uint32_t>(packed_vertices.size());
+            for (const uint32_t v : vertices)
+            {
+                packed_vertices.push_back(static_cast<uint16_t>(v & 0xffff));
+                packed_vertices.push_back(static_cast<uint16_t>(v >> 16));
+            }
+        }
+
+        const uint8_t* triangles = meshlet_triangles.data() + meshlet.triangle_offset;
+        meshlet.triangle_offset = static_cast<uint32_t>(packed_triangles.size());
+        for (uint32_t t = 0; t < meshlet.triangle_count; ++t)
+        {
+            packed_triangles.push_back(static_cast<uint16_t>(triangles[t * 3 + 0] | triangles[t * 3 + 1] << 5 |
+                                                             triangles[t * 3 + 2] << 10));
+        }
+    }
+
+    // The mesh shader fetches whole words.
+    if (packed_vertices.size() % 2 != 0) packed_vertices.push_back(0);
+    if (packed_triangles.size() % 2 != 0) packed_triangles.push_back(0);
+}
+
+static glm::u16vec4 quantize_sphere(const glm::vec4& sphere, const glm::vec3& origin, float step)
+{
+    const glm::vec3 center = glm::clamp(glm::round((glm::vec3(sphere) - origin) / step), 0.f, 65535.f);
+
+    // Rounding moves the center by up to half a step per axis, the radius grows to still cover the original sphere.
+    const float radius = std::ceil(sphere.w / step + 0.5f * std::sqrt(3.f));
+    return glm::u16vec4(center, std::min(radius, 65535.f));
+}
+
+static glm::uvec2 pack_sphere(const glm::u16vec4& sphere)
+{
+    return glm::uvec2(sphere.x | static_cast<uint32_t>(sphere.y) << 16, sphere.z | static_cast<uint32_t>(sphere.w) << 16);
+}
+
+// Quantizes every sphere the amplification shader reads relative to the bounds of all of them. LOD selection relies on a
+// group's sphere containing the spheres of the groups it was simplified from, rounding can break that by a step or two so
+// parents are grown back around their children in build order.
+static void build_cluster_data(std::span<const glm::vec4> cull_spheres,
+                               std::span<const uint32_t> cones,
+                               MeshClusterData& data)
+{
+    const std::vector<LODGroupData>& lod_groups = data.lod_groups;
+
+    glm::vec3 min(FLT_MAX), max(-FLT_MAX);
+    float max_radius = 0.f;
+    for (const glm::vec4& sphere : cull_spheres)
+    {
+        min = glm::min(min, glm::vec3(sphere));
+        max = glm::max(max, glm::vec3(sphere));
+        max_radius = std::max(max_radius, sphere.w);
+    }
+    for (const LODGroupData& group : lod_groups)
+    {
+        min = glm::min(min, group.center);
+        max = glm::max(max, group.center);
+        max_radius = std::max(max_radius, group.radius);
+    }
+
+    data.bounds_min = min;
+    data.bounds_step = std::max(std::max(glm::compMax(max - min), max_radius * 2.f) / CLUSTER_BOUNDS_STEPS, FLT_MIN);
+
+    std::vector<glm::u16vec4> group_spheres(lod_groups.size());
+    for (size_t g = 0; g < lod_groups.size(); ++g)
+    {
+        const LODGroupData& group = lod_groups[g];
+        glm::u16vec4& sphere = group_spheres[g];
+        sphere = quantize_sphere(glm::vec4(group.center, group.radius), data.bounds_min, data.bounds_step);
+
+        for (uint32_t c = group.cluster_start; c < group.cluster_start + group.cluster_count; ++c)
+        {
+            const int32_t refined = data.meshlets[c].parent_group_id;
+            if (refined < 0) continue;
+
+            const glm::u16vec4& child = group_spheres[refined];
+            const float distance = glm::distance(glm::vec3(sphere), glm::vec3(child));
+            sphere.w = static_cast<uint16_t>(std::min(std::max<float>(sphere.w, std::ceil(distance + child.w)), 65535.f));
+        }
+    }
+
+    data.clusters.resize(data.meshlets.size());
+    for (size_t m = 0; m < data.meshlets.size(); ++m)
+    {
+        const MeshletData& meshlet = data.meshlets[m];
+        ClusterData& cluster = data.clusters[m];
+
+        cluster.bounds = pack_sphere(quantize_sphere(cull_spheres[m], data.bounds_min, data.bounds_step));
+        cluster.parent_bounds = pack_sphere(group_spheres[meshlet.group_id]);
+        cluster.cone = cones[m];
+
+        float lod_error = 0.f;
+        if (meshlet.parent_group_id >= 0)
+        {
+            cluster.lod_bounds = pack_sphere(group_spheres[meshlet.parent_group_id]);
+            lod_error = lod_groups[meshlet.parent_group_id].error;
+        }
+        // Stored in steps like the spheres, so half precision covers meshes of any scale.
+        const glm::vec2 errors = glm::vec2(lod_error, lod_groups[meshlet.group_id].error) / data.bounds_step;
+        cluster.errors = glm::packHalf2x16(errors);
+    }
+}
+
+static MeshClusterData build_clusters(ThreadPool& threads,
+                                      const clodConfig& config,
+                                      float position_step,
+                                      std::span<const uint32_t> indices,
+                                      std::span<const glm::vec3> positions,
+                                      std::span<const ImportVertex> vertices)
+{
+    KX_ASSERT_MSG(config.max_vertices <= 32, "packed meshlet triangles only have 5 bits per local index");
+
+    MeshClusterData data;
+    data.position_step = position_step;
 
     clodMesh mesh{};
     mesh.indices = indices.data();
     mesh.index_count = indices.size();
     mesh.vertex_count = positions.size();
     mesh.vertex_positions = reinterpret_cast<const float*>(positions.data());
-    mesh.vertex_positions_stride = sizeof(glm::vec4);
+    mesh.vertex_positions_stride = sizeof(glm::vec3);
 
-    mesh.vertex_attributes = reinterpret_cast<const float*>(unindexed_vertices.data());
-    mesh.vertex_attributes_stride = sizeof(Vertex);
+    mesh.vertex_attributes = reinterpret_cast<const float*>(vertices.data());
+    mesh.vertex_attributes_stride = sizeof(ImportVertex);
     mesh.attribute_weights = VERTEX_ATTRIBUTE_WEIGHTS;
     mesh.attribute_count = VERTEX_ATTRIBUTE_COUNT;
-    mesh.attribute_protect_mask = 1u << 3 | 1u << 12;
+    mesh.attribute_protect_mask = CLUSTER_ATTRIBUTE_PROTECT_MASK;
     mesh.vertex_lock = nullptr;
 
-    std::vector<MeshletData> meshlets;
-    std::vector<LODGroupData> lod_groups;
+    std::vector<MeshletData>& meshlets = data.meshlets;
+    std::vector<LODGroupData>& lod_groups = data.lod_groups;
     std::vector<uint32_t> meshlet_vertices;
     std::vector<uint8_t> meshlet_triangles;
+    std::vector<glm::vec4> cull_spheres;
 
     uint32_t current_vertex_offset{0};
     uint32_t current_triangle_offset{0};
     uint32_t max_depth{0};
 
+    // Snapping moves every vertex by at most half a step per axis, which every level inherits on top of its simplification
+    // error. Adding it uniformly keeps parent errors above their children's, so LOD selection stays monotonic.
+    const float quantization_error = position_step * 0.5f * std::sqrt(3.f);
+
     clodBuild(config,
               mesh,
               [&](const clodGroup& group, const clodCluster* clusters, size_t cluster_count) -> int
               {
                   int group_id = static_cast<int>(lod_groups.size());
+                  max_depth = std::max(max_depth, static_cast<uint32_t>(group.depth));
 
                   LODGroupData lod_group;
                   lod_group.center =
                       glm::vec3(group.simplified.center[0], group.simplified.center[1], group.simplified.center[2]);
                   lod_group.radius = group.simplified.radius;
-                  lod_group.error = group.simplified.error;
+                  lod_group.error = group.simplified.error + quantization_error;
                   lod_group.depth = group.depth;
                   lod_group.cluster_start = static_cast<uint32_t>(meshlets.size());
                   lod_group.cluster_count = static_cast<uint32_t>(cluster_count);
@@ -89,14 +364,14 @@ Mesh::Mesh(const std::filesystem::path& path,
 
                       MeshletData meshlet{};
 
-                      meshlet.center = glm::vec3(cluster.bounds.center[0], cluster.bounds.center[1], cluster.bounds.center[2]);
-                      meshlet.radius = cluster.bounds.radius;
-
                       meshlet.group_id = group_id;
                       meshlet.parent_group_id = cluster.refined;
                       meshlet.lod_level = static_cast<uint8_t>(group.depth);
-                      meshlet.lod_error = cluster.bounds.error;
-                      meshlet.parent_error = group.simplified.error;
+
+                      cull_spheres.emplace_back(cluster.bounds.center[0],
+                                                cluster.bounds.center[1],
+                                                cluster.bounds.center[2],
+                                                cluster.bounds.radius);
 
                       size_t triangle_count = cluster.index_count / 3;
                       std::vector<unsigned int> local_vertices(cluster.vertex_count);
@@ -120,263 +395,410 @@ Mesh::Mesh(const std::filesystem::path& path,
                   }
 
                   return group_id;
-              });
+              },
+              [&threads](size_t count, const std::function<void(size_t)>& task) { threads.parallel_for(count, task); });
 
-    m_meshlet_count = meshlets.size();
-    m_lod_group_count = lod_groups.size();
-    m_max_lod_level = max_depth;
+    data.max_lod_level = max_depth;
 
-    fmt::print("Mesh '{}': {} clusters, {} LOD groups, {} levels\n",
-               path.string(),
-               m_meshlet_count,
-               m_lod_group_count,
-               m_max_lod_level + 1);
+    std::vector<uint32_t> cones(meshlets.size(), 0);
+
+    constexpr size_t CONE_BATCH_SIZE = 256;
+    threads.parallel_for(
+        (meshlets.size() + CONE_BATCH_SIZE - 1) / CONE_BATCH_SIZE,
+        [&](size_t batch)
+        {
+            std::vector<unsigned int> meshlet_indices;
 
-    for (uint32_t level = 0; level <= m_max_lod_level; ++level)
+            const size_t end = std::min(meshlets.size(), (batch + 1) * CONE_BATCH_SIZE);
+            for (size_t m = batch * CONE_BATCH_SIZE; m < end; ++m)
+            {
+                const MeshletData& meshlet = meshlets[m];
+                if (meshlet.triangle_count == 0) continue;
+
+                meshlet_indices.clear();
+                for (uint32_t t = 0; t < meshlet.triangle_count * 3u; ++t)
+                {
+                    uint8_t local_idx = meshlet_triangles[meshlet.triangle_offset + t];
+                    uint32_t global_idx = meshlet_vertices[meshlet.vertex_offset + local_idx];
+                    meshlet_indices.push_back(global_idx);
+                }
+
+                meshopt_Bounds bounds = meshopt_computeClusterBounds(meshlet_indices.data(),
+                                                                     meshlet_indices.size(),
+                                                                     reinterpret_cast<const float*>(positions.data()),
+                                                                     positions.size(),
+                                                                     sizeof(glm::vec3));
+
+                cones[m] = static_cast<uint8_t>(bounds.cone_axis_s8[0]) | static_cast<uint8_t>(bounds.cone_axis_s8[1]) << 8 |
+                           static_cast<uint8_t>(bounds.cone_axis_s8[2]) << 16 |
+                           static_cast<uint32_t>(static_cast<uint8_t>(bounds.cone_cutoff_s8)) << 24;
+
+                // Both spheres cover the triangles, the one clusterlod merged for LOD selection can be much looser.
+                if (bounds.radius < cull_spheres[m].w)
+                    cull_spheres[m] = glm::vec4(bounds.center[0], bounds.center[1], bounds.center[2], bounds.radius);
+            }
+        });
+
+    build_cluster_data(cull_spheres, cones, data);
+
+    if (position_step > 0.f) quantize_cluster_positions(threads, positions, meshlet_vertices, data);
+    pack_meshlet_indices(meshlet_vertices, meshlet_triangles, data);
+
+    return data;
+}
+
+// Meshes are built in parallel, the report is printed in one call so lines of different meshes don't interleave.
+static void print_cluster_stats(const std::filesystem::path& path, const MeshClusterData& data)
+{
+    std::string report = fmt::format("Mesh '{}': {} clusters, {} LOD groups, {} levels\n",
+                                     path.string(),
+                                     data.meshlets.size(),
+                                     data.lod_groups.size(),
+                                     data.max_lod_level + 1);
+
+    for (uint32_t level = 0; level <= data.max_lod_level; ++level)
     {
         float min_error = FLT_MAX, max_error = 0.0f;
         float min_parent = FLT_MAX, max_parent = 0.0f;
         uint32_t count = 0;
-        for (const auto& m : meshlets)
+        for (const auto& m : data.meshlets)
         {
             if (m.lod_level == level)
             {
-                min_error = std::min(min_error, m.lod_error);
-                max_error = std::max(max_error, m.lod_error);
-                min_parent = std::min(min_parent, m.parent_error);
-                max_parent = std::max(max_parent, m.parent_error);
+                const float lod_error = m.parent_group_id >= 0 ? data.lod_groups[m.parent_group_id].error : 0.f;
+                const float parent_error = data.lod_groups[m.group_id].error;
+
+                min_error = std::min(min_error, lod_error);
+                max_error = std::max(max_error, lod_error);
+                min_parent = std::min(min_parent, parent_error);
+                max_parent = std::max(max_parent, parent_error);
                 count++;
             }
         }
-        fmt::print("  LOD {}: {} clusters, error=[{:.4f}, {:.4f}], parent_error=[{:.4f}, {:.4f}]\n",
-                   level,
-                   count,
-                   min_error,
-                   max_error,
-                   min_parent,
-                   max_parent);
+        fmt::format_to(std::back_inserter(report),
+                       "  LOD {}: {} clusters, error=[{:.4f}, {:.4f}], parent_error=[{:.4f}, {:.4f}]\n",
+                       level,
+                       count,
+                       min_error,
+                       max_error,
+                       min_parent,
+                       max_parent);
     }
 
-    for (auto& meshlet : meshlets)
-    {
-        if (meshlet.triangle_count == 0) continue;
+    fmt::print("{}", report);
+}
 
-        std::vector<unsigned int> meshlet_indices;
-        meshlet_indices.reserve(meshlet.triangle_count * 3);
+static void calculate_bounds(std::span<const glm::vec3> positions, glm::vec3& centroid, float& radius)
+{
+    centroid = glm::vec3(0.f);
+    for (const auto& v : positions) centroid += v;
+    centroid /= static_cast<float>(positions.size());
 
-        for (uint32_t t = 0; t < meshlet.triangle_count * 3; ++t)
-        {
-            uint8_t local_idx = meshlet_triangles[meshlet.triangle_offset + t];
-            uint32_t global_idx = meshlet_vertices[meshlet.vertex_offset + local_idx];
-            meshlet_indices.push_back(global_idx);
-        }
+    radius = glm::distance2(positions[0], centroid);
+    for (const auto& v : positions) radius = std::max(radius, glm::distance2(v, centroid));
+    radius = std::nextafter(sqrtf(radius), std::numeric_limits<float>::max());
+}
 
-        meshopt_Bounds bounds = meshopt_computeClusterBounds(meshlet_indices.data(),
-                                                             meshlet_indices.size(),
-                                                             reinterpret_cast<const float*>(positions.data()),
-                                                             positions.size(),
-                                                             sizeof(glm::vec4));
+// Maps a unit vector onto the [-1, 1] square of an octahedron, see "A Survey of Efficient Representations for Independent
+// Unit Vectors" (Cigolle et al. 2014).
+static glm::vec2 encode_octahedral(glm::vec3 v)
+{
+    const float length = std::abs(v.x) + std::abs(v.y) + std::abs(v.z);
+    if (length == 0.f) return glm::vec2(0.f);
 
-        meshlet.cone_axis[0] = bounds.cone_axis_s8[0];
-        meshlet.cone_axis[1] = bounds.cone_axis_s8[1];
-        meshlet.cone_axis[2] = bounds.cone_axis_s8[2];
-        meshlet.cone_cutoff = bounds.cone_cutoff_s8;
-    }
+    v /= length;
+    if (v.z >= 0.f) return glm::vec2(v.x, v.y);
 
-    Device& device = Engine::get().device();
+    return glm::vec2((1.f - std::abs(v.y)) * (v.x >= 0.f ? 1.f : -1.f), (1.f - std::abs(v.x)) * (v.y >= 0.f ? 1.f : -1.f));
+}
 
-    const size_t index_buffer_size = indices.size() * sizeof(uint32_t);
-    const size_t position_buffer_size = positions.size() * sizeof(glm::vec4);
-    const size_t vertex_buffer_size = unindexed_vertices.size() * sizeof(Vertex);
+static Vertex pack_vertex(const ImportVertex& vertex)
+{
+    Vertex packed{};
+    packed.normal = glm::packSnorm2x16(encode_octahedral(vertex.normal));
 
-    const size_t meshlet_buffer_size = meshlets.size() * sizeof(MeshletData);
-    const size_t meshlet_vertices_buffer_size = meshlet_vertices.size() * sizeof(uint32_t);
-    const size_t meshlet_triangles_buffer_size = meshlet_triangles.size() * sizeof(uint8_t);
-    const size_t lod_groups_buffer_size = lod_groups.size() * sizeof(LODGroupData);
-
-    m_index_buffer = device.create_buffer(index_buffer_size,
-                                          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
-                                              VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
-                                              VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-                                          VMA_MEMORY_USAGE_GPU_ONLY);
-    {
-        VkBufferDeviceAddressInfo device_address_info{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-                                                      .buffer = m_index_buffer.buffer};
-        m_index_buffer_address = vkGetBufferDeviceAddress(device.get(), &device_address_info);
-    }
+    const glm::vec2 tangent = glm::clamp(encode_octahedral(glm::vec3(vertex.tangent)) * 0.5f + 0.5f, 0.f, 1.f);
+    packed.tangent = static_cast<uint32_t>(std::round(tangent.x * 32767.f)) |
+                     static_cast<uint32_t>(std::round(tangent.y * 32767.f)) << 15 |
+                     (vertex.tangent.w < 0.f ? 1u << 31 : 0u);
 
-    m_position_buffer = device.create_buffer(position_buffer_size,
-                                             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
-                                                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-                                             VMA_MEMORY_USAGE_GPU_ONLY);
-    {
-        VkBufferDeviceAddressInfo device_address_info{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-                                                      .buffer = m_position_buffer.buffer};
-        m_position_buffer_address = vkGetBufferDeviceAddress(device.get(), &device_address_info);
-    }
+    packed.uv = glm::packHalf2x16(glm::vec2(vertex.uv_x, vertex.uv_y));
+    packed.color = glm::packUnorm4x8(vertex.color);
 
-    m_vertex_buffer = device.create_buffer(vertex_buffer_size,
-                                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
-                                               VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-                                           VMA_MEMORY_USAGE_GPU_ONLY);
-    {
-        VkBufferDeviceAddressInfo device_address_info{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-                                                      .buffer = m_vertex_buffer.buffer};
-        m_vertex_buffer_address = vkGetBufferDeviceAddress(device.get(), &device_address_info);
-    }
+    return packed;
+}
 
-    m_meshlet_buffer = device.create_buffer(meshlet_buffer_size,
-                                            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
-                                                VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-                                            VMA_MEMORY_USAGE_GPU_ONLY);
-    {
-        VkBufferDeviceAddressInfo device_address_info{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-                                                      .buffer = m_meshlet_buffer.buffer};
-        m_meshlet_buffer_address = vkGetBufferDeviceAddress(device.get(), &device_address_info);
-    }
+// The index and vertex paths draw the imported triangle list directly, so it's laid out for them. Everything built
+// afterwards, clusters, LODs and their vertex references, comes from the reordered mesh and can't go out of sync with it.
+static void optimize_vertex_order(std::vector<uint32_t>& indices,
+                                  std::vector<glm::vec3>& positions,
+                                  std::vector<ImportVertex>& vertices)
+{
+    if (indices.empty()) return;
+
+    const size_t vertex_count = positions.size();
+
+    meshopt_optimizeVertexCache(indices.data(), indices.data(), indices.size(), vertex_count);
+    meshopt_optimizeOverdraw(indices.data(),
+                             indices.data(),
+                             indices.size(),
+                             &positions[0].x,
+                             vertex_count,
+                             sizeof(glm::vec3),
+                             OVERDRAW_THRESHOLD);
+
+    // Also drops vertices no triangle references.
+    std::vector<uint32_t> remap(vertex_count);
+    const size_t unique_count = meshopt_optimizeVertexFetchRemap(remap.data(), indices.data(), indices.size(), vertex_count);
+
+    meshopt_remapIndexBuffer(indices.data(), indices.data(), indices.size(), remap.data());
+    meshopt_remapVertexBuffer(positions.data(), positions.data(), vertex_count, sizeof(glm::vec3), remap.data());
+    meshopt_remapVertexBuffer(vertices.data(), vertices.data(), vertex_count, sizeof(ImportVertex), remap.data());
+    positions.resize(unique_count);
+    vertices.resize(unique_count);
+}
 
-    m_meshlet_vertices_buffer =
-        device.create_buffer(meshlet_vertices_buffer_size,
-                             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
-                                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-                             VMA_MEMORY_USAGE_GPU_ONLY);
+MeshData Mesh::build(const std::filesystem::path& path,
+                     ThreadPool& threads,
+                     std::vector<uint32_t>&& indices,
+                     std::vector<glm::vec3>&& positions,
+                     std::vector<ImportVertex>&& vertices)
+{
+    if constexpr (OPTIMIZE_VERTEX_ORDER) optimize_vertex_order(indices, positions, vertices);
+
+    MeshData data;
+    data.indices = std::move(indices);
+    data.positions = std::move(positions);
+
+    // Positions are snapped before anything is built from them, so bounds, cones and both render paths see the same grid.
+    const float position_step = QUANTIZE_CLUSTER_POSITIONS ? get_position_step(data.positions) : 0.f;
+    if (position_step > 0.f) snap_positions(data.positions, position_step);
+
+    // Simplification weighs the full precision attributes, they're only packed once the hierarchy exists.
+    const clodConfig config = get_cluster_config();
+    const uint64_t cache_key = get_cluster_cache_key(config, position_step, data.indices, data.positions, vertices);
+
+    if (!mesh_cache::load(cache_key, data.clusters))
     {
-        VkBufferDeviceAddressInfo device_address_info{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-                                                      .buffer = m_meshlet_vertices_buffer.buffer};
-        m_meshlet_vertices_buffer_address = vkGetBufferDeviceAddress(device.get(), &device_address_info);
+        data.clusters = build_clusters(threads, config, position_step, data.indices, data.positions, vertices);
+        calculate_bounds(data.positions, data.clusters.centroid, data.clusters.radius);
+
+        print_cluster_stats(path, data.clusters);
+
+        mesh_cache::store(cache_key, data.clusters);
     }
 
-    m_meshlet_triangles_buffer =
-        device.create_buffer(meshlet_triangles_buffer_size,
-                             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
-                                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-                             VMA_MEMORY_USAGE_GPU_ONLY);
+    data.vertices.resize(vertices.size());
+    std::ranges::transform(vertices, data.vertices.begin(), pack_vertex);
+
+    // Primitive restart is never enabled, so 0xffff is an ordinary index.
+    if (data.positions.size() <= 1u << 16)
     {
-        VkBufferDeviceAddressInfo device_address_info{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-                                                      .buffer = m_meshlet_triangles_buffer.buffer};
-        m_meshlet_triangles_buffer_address = vkGetBufferDeviceAddress(device.get(), &device_address_info);
+        data.short_indices.resize(data.indices.size());
+        std::ranges::transform(data.indices, data.short_indices.begin(), [](uint32_t i) { return static_cast<uint16_t>(i); });
+        data.indices = {};
     }
 
-    m_lod_groups_buffer = device.create_buffer(lod_groups_buffer_size,
-                                               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
-                                                   VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-                                               VMA_MEMORY_USAGE_GPU_ONLY);
+    return data;
+}
+
+// Encoded streams are decoded straight into the staging buffer when the batch is flushed.
+static void upload_stream(UploadBatch& uploads, VkBuffer buffer, VkDeviceSize offset, const GeometryStream& stream)
+{
+    if (stream.encoded.empty())
     {
-        VkBufferDeviceAddressInfo device_address_info{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-                                                      .buffer = m_lod_groups_buffer.buffer};
-        m_lod_groups_buffer_address = vkGetBufferDeviceAddress(device.get(), &device_address_info);
+        uploads.upload(buffer, offset, stream.data, stream.size);
+        return;
     }
 
-    const size_t total_staging_size = index_buffer_size + position_buffer_size + vertex_buffer_size + meshlet_buffer_size +
-                                      meshlet_vertices_buffer_size + meshlet_triangles_buffer_size + lod_groups_buffer_size;
+    const std::span<const uint8_t> encoded = stream.encoded;
+    uploads.upload(buffer,
+                   offset,
+                   stream.size,
+                   [encoded](void* destination)
+                   {
+                       // Streams are checksummed when the asset is opened, corrupt ones are rebaked and never get here.
+                       const bool decoded = geometry_codec::decode(encoded, destination, Engine::get().threads());
+                       KX_ASSERT_MSG(decoded, "Failed to decode geometry stream");
+                   });
+}
 
-    AllocatedBuffer staging =
-        device.create_buffer(total_staging_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY);
+static VkDeviceSize align_meshlet_stream(VkDeviceSize offset)
+{
+    return (offset + MESHLET_ELEMENT_SIZE - 1) & ~static_cast<VkDeviceSize>(MESHLET_ELEMENT_SIZE - 1);
+}
 
-    void* data;
-    vmaMapMemory(device.get_allocator(), staging.allocation, &data);
+// Byte offsets of the meshlet data streams in a mesh's meshlet range, each starting on an element boundary. The meshlets
+// themselves come first.
+struct MeshletLayout
+{
+    VkDeviceSize meshlet_vertices;
+    VkDeviceSize meshlet_triangles;
+    VkDeviceSize clusters;
+    VkDeviceSize meshlet_positions;
+    VkDeviceSize element_count;
+};
+
+static MeshletLayout get_meshlet_layout(const MeshDataView& data)
+{
+    MeshletLayout layout;
+    layout.meshlet_vertices = align_meshlet_stream(data.meshlets.size_bytes());
+    layout.meshlet_triangles = align_meshlet_stream(layout.meshlet_vertices + data.meshlet_vertices.size);
+    layout.clusters = align_meshlet_stream(layout.meshlet_triangles + data.meshlet_triangles.size);
+    layout.meshlet_positions = align_meshlet_stream(layout.clusters + data.clusters.size_bytes());
+    layout.element_count = align_meshlet_stream(layout.meshlet_positions + data.meshlet_positions.size) / MESHLET_ELEMENT_SIZE;
+    return layout;
+}
 
-    size_t offset = 0;
-    memcpy(static_cast<char*>(data) + offset, indices.data(), index_buffer_size);
-    offset += index_buffer_size;
+MeshDataView MeshData::view() const
+{
+    MeshDataView view;
+    view.indices = indices;
+    view.short_indices = short_indices;
+    view.positions = positions;
+    view.vertices = vertices;
+    view.clusters = clusters.clusters;
+    view.meshlets = clusters.meshlets;
+    view.meshlet_vertices = clusters.meshlet_vertices;
+    view.meshlet_triangles = clusters.meshlet_triangles;
+    view.meshlet_positions = clusters.meshlet_positions;
+    view.position_step = clusters.position_step;
+    view.bounds_min = clusters.bounds_min;
+    view.bounds_step = clusters.bounds_step;
+    view.max_lod_level = clusters.max_lod_level;
+    view.centroid = clusters.centroid;
+    view.radius = clusters.radius;
+    return view;
+}
 
-    memcpy(static_cast<char*>(data) + offset, positions.data(), position_buffer_size);
-    offset += position_buffer_size;
+Mesh::Mesh(const std::filesystem::path& path,
+           uint32_t mesh_index,
+           const MeshDataView& data,
+           std::shared_ptr<Material> material,
+           UploadBatch& uploads)
+    : Resource(Type::Mesh, path.string()),
+      m_mesh_index(mesh_index),
+      m_index_count(static_cast<uint32_t>(data.short_indices.empty() ? data.indices.count<uint32_t>()
+                                                                     : data.short_indices.count<uint16_t>())),
+      m_vertex_count(static_cast<uint32_t>(data.vertices.count<Vertex>())),
+      m_material(std::move(material))
+{
+    const std::span<const ClusterData> clusters = data.clusters;
+    const std::span<const MeshletData> meshlets = data.meshlets;
 
-    memcpy(static_cast<char*>(data) + offset, unindexed_vertices.data(), vertex_buffer_size);
-    offset += vertex_buffer_size;
+    m_meshlet_count = meshlets.size();
+    m_max_lod_level = data.max_lod_level;
+    m_position_step = data.position_step;
+    m_bounds_min = data.bounds_min;
+    m_bounds_step = data.bounds_step;
 
-    memcpy(static_cast<char*>(data) + offset, meshlets.data(), meshlet_buffer_size);
-    offset += meshlet_buffer_size;
+    m_centroid = data.centroid;
+    m_radius = data.radius;
 
-    memcpy(static_cast<char*>(data) + offset, meshlet_vertices.data(), meshlet_vertices_buffer_size);
-    offset += meshlet_vertices_buffer_size;
+    GeometryArena& geometry = Engine::get().resources().geometry();
 
-    memcpy(static_cast<char*>(data) + offset, meshlet_triangles.data(), meshlet_triangles_buffer_size);
-    offset += meshlet_triangles_buffer_size;
+    m_index_type = data.short_indices.empty() ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16;
+    const GeometryStream& indices = m_index_type == VK_INDEX_TYPE_UINT16 ? data.short_indices : data.indices;
 
-    memcpy(static_cast<char*>(data) + offset, lod_groups.data(), lod_groups_buffer_size);
+    const size_t meshlet_buffer_size = meshlets.size() * sizeof(MeshletData);
+    const size_t cluster_buffer_size = clusters.size() * sizeof(ClusterData);
+
+    const MeshletLayout meshlet_layout = get_meshlet_layout(data);
+    m_meshlet_vertices_offset = meshlet_layout.meshlet_vertices;
+    m_meshlet_triangles_offset = meshlet_layout.meshlet_triangles;
+    m_cluster_offset = meshlet_layout.clusters;
+    m_meshlet_positions_offset = meshlet_layout.meshlet_positions;
+
+    m_index_range = geometry.allocate(m_index_type == VK_INDEX_TYPE_UINT16 ? GeometryPool::ShortIndices
+                                                                           : GeometryPool::Indices,
+                                      m_index_count,
+                                      uploads);
+    m_vertex_range = geometry.allocate(GeometryPool::Vertices, m_vertex_count, uploads);
+    m_meshlet_range = geometry.allocate(GeometryPool::Meshlets, meshlet_layout.element_count, uploads);
+    m_has_meshlet_positions = data.meshlet_positions.size > 0;
+
+    m_first_index = static_cast<uint32_t>(m_index_range.offset);
+    m_first_vertex = static_cast<uint32_t>(m_vertex_range.offset);
+
+    // Pools only swap buffers when they grow in allocate, which flushes uploads first, so these stay valid for the queue.
+    const VkBuffer index_buffer = geometry.get_buffer(m_index_range.pool);
+    const VkBuffer position_buffer = geometry.get_buffer(GeometryPool::Vertices, 0);
+    const VkBuffer vertex_buffer = geometry.get_buffer(GeometryPool::Vertices, 1);
+    const VkBuffer meshlet_buffer = geometry.get_buffer(GeometryPool::Meshlets);
+    const VkDeviceSize meshlet_offset = geometry.get_offset(m_meshlet_range);
+
+    upload_stream(uploads, index_buffer, geometry.get_offset(m_index_range), indices);
+    upload_stream(uploads, position_buffer, geometry.get_offset(m_vertex_range, 0), data.positions);
+    upload_stream(uploads, vertex_buffer, geometry.get_offset(m_vertex_range, 1), data.vertices);
+    uploads.upload(meshlet_buffer, meshlet_offset, meshlets.data(), meshlet_buffer_size);
+    upload_stream(uploads, meshlet_buffer, meshlet_offset + m_meshlet_vertices_offset, data.meshlet_vertices);
+    upload_stream(uploads, meshlet_buffer, meshlet_offset + m_meshlet_triangles_offset, data.meshlet_triangles);
+    uploads.upload(meshlet_buffer, meshlet_offset + m_cluster_offset, clusters.data(), cluster_buffer_size);
+    upload_stream(uploads, meshlet_buffer, meshlet_offset + m_meshlet_positions_offset, data.meshlet_positions);
+}
 
-    vmaUnmapMemory(device.get_allocator(), staging.allocation);
+void Mesh::reserve_geometry(std::span<const MeshDataView> meshes, UploadBatch& uploads)
+{
+    VkDeviceSize counts[static_cast<size_t>(GeometryPool::Count)]{};
+    for (const MeshDataView& data : meshes)
+    {
+        if (data.short_indices.empty())
+            counts[static_cast<size_t>(GeometryPool::Indices)] += data.indices.count<uint32_t>();
+        else
+            counts[static_cast<size_t>(GeometryPool::ShortIndices)] += data.short_indices.count<uint16_t>();
 
-    device.immediate_submit(
-        [&](const CommandBuffer& cmd)
-        {
-            size_t src_offset = 0;
-
-            VkBufferCopy index_copy{};
-            index_copy.dstOffset = 0;
-            index_copy.srcOffset = src_offset;
-            index_copy.size = index_buffer_size;
-            cmd.copy_buffer(staging.buffer, m_index_buffer.buffer, 1, &index_copy);
-            src_offset += index_buffer_size;
-
-            VkBufferCopy position_copy{};
-            position_copy.dstOffset = 0;
-            position_copy.srcOffset = src_offset;
-            position_copy.size = position_buffer_size;
-            cmd.copy_buffer(staging.buffer, m_position_buffer.buffer, 1, &position_copy);
-            src_offset += position_buffer_size;
-
-            VkBufferCopy vertex_copy{};
-            vertex_copy.dstOffset = 0;
-            vertex_copy.srcOffset = src_offset;
-            vertex_copy.size = vertex_buffer_size;
-            cmd.copy_buffer(staging.buffer, m_vertex_buffer.buffer, 1, &vertex_copy);
-            src_offset += vertex_buffer_size;
-
-            VkBufferCopy meshlet_copy{};
-            meshlet_copy.dstOffset = 0;
-            meshlet_copy.srcOffset = src_offset;
-            meshlet_copy.size = meshlet_buffer_size;
-            cmd.copy_buffer(staging.buffer, m_meshlet_buffer.buffer, 1, &meshlet_copy);
-            src_offset += meshlet_buffer_size;
-
-            VkBufferCopy meshlet_vertices_copy{};
-            meshlet_vertices_copy.dstOffset = 0;
-            meshlet_vertices_copy.srcOffset = src_offset;
-            meshlet_vertices_copy.size = meshlet_vertices_buffer_size;
-            cmd.copy_buffer(staging.buffer, m_meshlet_vertices_buffer.buffer, 1, &meshlet_vertices_copy);
-            src_offset += meshlet_vertices_buffer_size;
-
-            VkBufferCopy meshlet_triangles_copy{};
-            meshlet_triangles_copy.dstOffset = 0;
-            meshlet_triangles_copy.srcOffset = src_offset;
-            meshlet_triangles_copy.size = meshlet_triangles_buffer_size;
-            cmd.copy_buffer(staging.buffer, m_meshlet_triangles_buffer.buffer, 1, &meshlet_triangles_copy);
-            src_offset += meshlet_triangles_buffer_size;
-
-            VkBufferCopy lod_groups_copy{};
-            lod_groups_copy.dstOffset = 0;
-            lod_groups_copy.srcOffset = src_offset;
-            lod_groups_copy.size = lod_groups_buffer_size;
-            cmd.copy_buffer(staging.buffer, m_lod_groups_buffer.buffer, 1, &lod_groups_copy);
-        });
+        counts[static_cast<size_t>(GeometryPool::Vertices)] += data.vertices.count<Vertex>();
+        counts[static_cast<size_t>(GeometryPool::Meshlets)] += get_meshlet_layout(data).element_count;
+    }
 
-    device.destroy_buffer(staging);
+    GeometryArena& geometry = Engine::get().resources().geometry();
+    for (size_t pool = 0; pool < std::size(counts); pool++)
+        geometry.reserve(static_cast<GeometryPool>(pool), counts[pool], uploads);
 }
 
 Mesh::~Mesh()
 {
-    const Device& device = Engine::get().device();
+    GeometryArena& geometry = Engine::get().resources().geometry();
 
-    device.destroy_buffer(m_index_buffer);
-    device.destroy_buffer(m_vertex_buffer);
-    device.destroy_buffer(m_position_buffer);
+    geometry.free(m_index_range);
+    geometry.free(m_vertex_range);
+    geometry.free(m_meshlet_range);
+}
 
-    device.destroy_buffer(m_meshlet_buffer);
-    device.destroy_buffer(m_meshlet_vertices_buffer);
-    device.destroy_buffer(m_meshlet_triangles_buffer);
-    device.destroy_buffer(m_lod_groups_buffer);
+VkDeviceAddress Mesh::get_index_buffer_address() const
+{
+    return Engine::get().resources().geometry().get_address(m_index_range);
 }
 
-void Mesh::calculate_bounds(const std::span<glm::vec4>& positions)
+VkDeviceAddress Mesh::get_position_buffer_address() const
 {
-    m_centroid = glm::vec3(0.f);
-    for (const auto& v : positions) m_centroid += glm::vec3(v);
-    m_centroid /= static_cast<float>(positions.size());
-
-    m_radius = glm::distance2(glm::vec3(positions[0]), m_centroid);
-    for (const auto& v : positions) m_radius = std::max(m_radius, glm::distance2(glm::vec3(v), m_centroid));
-    m_radius = std::nextafter(sqrtf(m_radius), std::numeric_limits<float>::max());
-}
\ No newline at end of file
+    return Engine::get().resources().geometry().get_address(m_vertex_range, 0);
+}
+
+VkDeviceAddress Mesh::get_vertex_buffer_address() const
+{
+    return Engine::get().resources().geometry().get_address(m_vertex_range, 1);
+}
+
+VkDeviceAddress Mesh::get_meshlet_buffer_address() const
+{
+    return Engine::get().resources().geometry().get_address(m_meshlet_range);
+}
+
+VkDeviceAddress Mesh::get_meshlet_vertices_buffer_address() const
+{
+    return get_meshlet_buffer_address() + m_meshlet_vertices_offset;
+}
+
+VkDeviceAddress Mesh::get_meshlet_triangles_buffer_address() const
+{
+    return get_meshlet_buffer_address() + m_meshlet_triangles_offset;
+}
+
+VkDeviceAddress Mesh::get_cluster_buffer_address() const { return get_meshlet_buffer_address() + m_cluster_offset; }
+
+VkDeviceAddress Mesh::get_meshlet_positions_buffer_address() const
+{
+    if (!m_has_meshlet_positions) return 0;
+    return get_meshlet_buffer_address() + m_meshlet_positions_offset;
+}
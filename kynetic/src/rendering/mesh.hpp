@@ -4,22 +4,67 @@
 
 #pragma once
 
+#include "geometry_arena.hpp"
+#include "geometry_codec.hpp"
+#include "mesh_cache.hpp"
+
 struct meshopt_Meshlet;
 
 namespace kynetic
 {
 
+// Non-owning view of everything a Mesh uploads, backed either by MeshData or by a mapped asset file. The bulk streams may
+// still be encoded, they're then decoded on upload.
+struct MeshDataView
+{
+    GeometryStream indices;        // uint32_t
+    GeometryStream short_indices;  // uint16_t, used instead of indices when set
+    GeometryStream positions;      // glm::vec3
+    GeometryStream vertices;       // Vertex
+
+    std::span<const ClusterData> clusters;
+    std::span<const MeshletData> meshlets;
+    GeometryStream meshlet_vertices;   // uint16_t
+    GeometryStream meshlet_triangles;  // uint16_t
+    GeometryStream meshlet_positions;  // uint16_t
+
+    float position_step{0.f};
+    uint32_t max_lod_level{0};
+
+    glm::vec3 bounds_min{0.f};
+    float bounds_step{0.f};
+
+    glm::vec3 centroid{0.f};
+    float radius{0.f};
+};
+
+// CPU side result of building a mesh, produced by Mesh::build and consumed by the Mesh constructor.
+struct MeshData
+{
+    std::vector<uint32_t> indices;
+    std::vector<uint16_t> short_indices;  // replaces indices when every vertex is reachable with 16 bits
+    std::vector<glm::vec3> positions;
+    std::vector<Vertex> vertices;
+
+    MeshClusterData clusters;
+
+    [[nodiscard]] MeshDataView view() const;
+};
+
 class Mesh : public Resource
 {
     friend class ResourceManager;
 
-    AllocatedBuffer m_index_buffer;
-    AllocatedBuffer m_position_buffer;
-    AllocatedBuffer m_vertex_buffer;
-    AllocatedBuffer m_meshlet_buffer;
-    AllocatedBuffer m_meshlet_vertices_buffer;
-    AllocatedBuffer m_meshlet_triangles_buffer;
-    AllocatedBuffer m_lod_groups_buffer;
+    GeometryRange m_index_range;
+    GeometryRange m_vertex_range;
+    GeometryRange m_meshlet_range;
+
+    // Byte offsets of the meshlet data streams in m_meshlet_range, the meshlets themselves come first.
+    VkDeviceSize m_meshlet_vertices_offset{0};
+    VkDeviceSize m_meshlet_triangles_offset{0};
+    VkDeviceSize m_cluster_offset{0};
+    VkDeviceSize m_meshlet_positions_offset{0};
+    bool m_has_meshlet_positions{false};
 
     uint32_t m_mesh_index;
 
@@ -30,18 +75,13 @@ class Mesh : public Resource
     uint32_t m_vertex_count{0};
 
     size_t m_meshlet_count{0};
-    size_t m_lod_group_count{0};
     uint32_t m_max_lod_level{0};
+    float m_position_step{0.f};
 
-    VkIndexType m_index_type{VK_INDEX_TYPE_UINT32};
+    glm::vec3 m_bounds_min{0.f};
+    float m_bounds_step{0.f};
 
-    VkDeviceAddress m_index_buffer_address;
-    VkDeviceAddress m_position_buffer_address;
-    VkDeviceAddress m_vertex_buffer_address;
-    VkDeviceAddress m_meshlet_buffer_address;
-    VkDeviceAddress m_meshlet_vertices_buffer_address;
-    VkDeviceAddress m_meshlet_triangles_buffer_address;
-    VkDeviceAddress m_lod_groups_buffer_address;
+    VkIndexType m_index_type{VK_INDEX_TYPE_UINT32};
 
     std::shared_ptr<class Material> m_material;
 
@@ -49,19 +89,29 @@ class Mesh : public Resource
     float m_radius{0.0f};
 
 public:
+    // Allocates the geometry ranges and queues their contents on uploads, the viewed memory has to outlive the next flush.
     Mesh(const std::filesystem::path& path,
          uint32_t mesh_index,
-         std::span<uint32_t> unindexed_indices,
-         std::span<glm::vec4> unindexed_positions,
-         std::span<Vertex> unindexed_vertices,
-         std::shared_ptr<Material> material);
-    void calculate_bounds(const std::span<glm::vec4>& positions);
+         const MeshDataView& data,
+         std::shared_ptr<Material> material,
+         class UploadBatch& uploads);
     ~Mesh() override;
 
-    [[nodiscard]] const VkBuffer& get_indices() const { return m_index_buffer.buffer; }
-    [[nodiscard]] const VkBuffer& get_vertices() const { return m_vertex_buffer.buffer; }
+    // Makes room in the geometry arena for all of meshes at once, so constructing them appends instead of growing the
+    // pools one mesh at a time.
+    static void reserve_geometry(std::span<const MeshDataView> meshes, class UploadBatch& uploads);
+
+    // Builds the cluster hierarchy, or loads it from the mesh cache, and packs the vertices. Touches no GPU or engine state, so
+    // it is safe to call from worker threads.
+    static MeshData build(const std::filesystem::path& path,
+                          class ThreadPool& threads,
+                          std::vector<uint32_t>&& indices,
+                          std::vector<glm::vec3>&& positions,
+                          std::vector<ImportVertex>&& vertices);
+
     [[nodiscard]] VkIndexType get_index_type() const { return m_index_type; }
 
+    // Relative to the geometry pool of the index type and to the vertex pool.
     [[nodiscard]] uint32_t get_index_offset() const { return m_first_index; }
     [[nodiscard]] uint32_t get_index_count() const { return m_index_count; }
 
@@ -69,16 +119,20 @@ public:
     [[nodiscard]] uint32_t get_vertex_count() const { return m_vertex_count; }
 
     [[nodiscard]] size_t get_meshlet_count() const { return m_meshlet_count; }
-    [[nodiscard]] size_t get_lod_group_count() const { return m_lod_group_count; }
     [[nodiscard]] uint32_t get_max_lod_level() const { return m_max_lod_level; }
-
-    [[nodiscard]] VkDeviceAddress get_index_buffer_address() const { return m_index_buffer_address; }
-    [[nodiscard]] VkDeviceAddress get_position_buffer_address() const { return m_position_buffer_address; }
-    [[nodiscard]] VkDeviceAddress get_vertex_buffer_address() const { return m_vertex_buffer_address; }
-    [[nodiscard]] VkDeviceAddress get_meshlet_buffer_address() const { return m_meshlet_buffer_address; }
-    [[nodiscard]] VkDeviceAddress get_meshlet_vertices_buffer_address() const { return m_meshlet_vertices_buffer_address; }
-    [[nodiscard]] VkDeviceAddress get_meshlet_triangles_buffer_address() const { return m_meshlet_triangles_buffer_address; }
-    [[nodiscard]] VkDeviceAddress get_lod_groups_buffer_address() const { return m_lod_groups_buffer_address; }
+    [[nodiscard]] float get_position_step() const { return m_position_step; }
+    [[nodiscard]] glm::vec3 get_bounds_min() const { return m_bounds_min; }
+    [[nodiscard]] float get_bounds_step() const { return m_bounds_step; }
+
+    // Addresses into the geometry arena, they change when a pool grows so they're looked up every time.
+    [[nodiscard]] VkDeviceAddress get_index_buffer_address() const;
+    [[nodiscard]] VkDeviceAddress get_position_buffer_address() const;
+    [[nodiscard]] VkDeviceAddress get_vertex_buffer_address() const;
+    [[nodiscard]] VkDeviceAddress get_meshlet_buffer_address() const;
+    [[nodiscard]] VkDeviceAddress get_meshlet_vertices_buffer_address() const;
+    [[nodiscard]] VkDeviceAddress get_meshlet_triangles_buffer_address() const;
+    [[nodiscard]] VkDeviceAddress get_cluster_buffer_address() const;
+    [[nodiscard]] VkDeviceAddress get_meshlet_positions_buffer_address() const;
 
     [[nodiscard]] const std::shared_ptr<Material>& get_material() const { return m_material; }
 
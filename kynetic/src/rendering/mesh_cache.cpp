@@ -0,0 +1,156 @@
+//
+// Created by kenny on 12/1/25.
+//
+
+#include "mesh_cache.hpp"
+
+#include <fstream>
+
+using namespace kynetic;
+
+constexpr uint32_t MESH_CACHE_MAGIC = 0x48534d4b;  // "KMSH"
+
+struct MeshCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+
+    uint64_t meshlet_count;
+    uint64_t lod_group_count;
+    uint64_t meshlet_vertex_count;
+    uint64_t meshlet_triangle_count;
+    uint64_t meshlet_position_count;
+
+    uint32_t max_lod_level;
+    float radius;
+    float centroid[3];
+    float position_step;
+
+    float bounds_min[3];
+    float bounds_step;
+};
+
+template <typename T>
+static bool read_array(std::ifstream& file, std::vector<T>& out, uint64_t count)
+{
+    out.resize(count);
+    file.read(reinterpret_cast<char*>(out.data()), static_cast<std::streamsize>(count * sizeof(T)));
+    return file.good();
+}
+
+template <typename T>
+static void write_array(std::ofstream& file, const std::vector<T>& in)
+{
+    file.write(reinterpret_cast<const char*>(in.data()), static_cast<std::streamsize>(in.size() * sizeof(T)));
+}
+
+std::filesystem::path mesh_cache::get_path(uint64_t key)
+{
+    return std::filesystem::path(CACHE_DIRECTORY) / "mesh" / fmt::format("{:016x}.kmesh", key);
+}
+
+bool mesh_cache::load(uint64_t key, MeshClusterData& data)
+{
+    std::ifstream file(get_path(key), std::ios::binary);
+    if (!file) return false;
+
+    MeshCacheHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || header.magic != MESH_CACHE_MAGIC || header.version != VERSION || header.key != key) return false;
+
+    const uint64_t expected_size = sizeof(MeshCacheHeader) + header.meshlet_count * sizeof(ClusterData) +
+                                   header.meshlet_count * sizeof(MeshletData) +
+                                   header.lod_group_count * sizeof(LODGroupData) +
+                                   header.meshlet_vertex_count * sizeof(uint16_t) +
+                                   header.meshlet_triangle_count * sizeof(uint16_t) +
+                                   header.meshlet_position_count * sizeof(uint16_t);
+
+    std::error_code error;
+    if (std::filesystem::file_size(get_path(key), error) != expected_size || error)
+    {
+        fmt::print(stderr, "Mesh cache entry '{}' is corrupt, rebuilding\n", get_path(key).string());
+        return false;
+    }
+
+    if (!read_array(file, data.clusters, header.meshlet_count) || !read_array(file, data.meshlets, header.meshlet_count) ||
+        !read_array(file, data.lod_groups, header.lod_group_count) ||
+        !read_array(file, data.meshlet_vertices, header.meshlet_vertex_count) ||
+        !read_array(file, data.meshlet_triangles, header.meshlet_triangle_count) ||
+        !read_array(file, data.meshlet_positions, header.meshlet_position_count))
+    {
+        fmt::print(stderr, "Mesh cache entry '{}' could not be read, rebuilding\n", get_path(key).string());
+        return false;
+    }
+
+    data.max_lod_level = header.max_lod_level;
+    data.centroid = glm::vec3(header.centroid[0], header.centroid[1], header.centroid[2]);
+    data.radius = header.radius;
+    data.position_step = header.position_step;
+    data.bounds_min = glm::vec3(header.bounds_min[0], header.bounds_min[1], header.bounds_min[2]);
+    data.bounds_step = header.bounds_step;
+
+    return true;
+}
+
+void mesh_cache::store(uint64_t key, const MeshClusterData& data)
+{
+    const std::filesystem::path path = get_path(key);
+
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+    if (error)
+    {
+        fmt::print(stderr, "Failed to create mesh cache directory '{}': {}\n", path.parent_path().string(), error.message());
+        return;
+    }
+
+    MeshCacheHeader header{};
+    header.magic = MESH_CACHE_MAGIC;
+    header.version = VERSION;
+    header.key = key;
+    header.meshlet_count = data.meshlets.size();
+    header.lod_group_count = data.lod_groups.size();
+    header.meshlet_vertex_count = data.meshlet_vertices.size();
+    header.meshlet_triangle_count = data.meshlet_triangles.size();
+    header.meshlet_position_count = data.meshlet_positions.size();
+    header.max_lod_level = data.max_lod_level;
+    header.radius = data.radius;
+    header.centroid[0] = data.centroid.x;
+    header.centroid[1] = data.centroid.y;
+    header.centroid[2] = data.centroid.z;
+    header.position_step = data.position_step;
+    header.bounds_min[0] = data.bounds_min.x;
+    header.bounds_min[1] = data.bounds_min.y;
+    header.bounds_min[2] = data.bounds_min.z;
+    header.bounds_step = data.bounds_step;
+
+    // Write to a temporary file first so a crash mid-write never leaves a valid looking entry behind.
+    std::filesystem::path temp_path = path;
+    temp_path += fmt::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+    bool written;
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        write_array(file, data.clusters);
+        write_array(file, data.meshlets);
+        write_array(file, data.lod_groups);
+        write_array(file, data.meshlet_vertices);
+        write_array(file, data.meshlet_triangles);
+        write_array(file, data.meshlet_positions);
+
+        written = file.good();
+    }
+
+    if (!written)
+    {
+        fmt::print(stderr, "Failed to write mesh cache entry '{}'\n", path.string());
+        std::filesystem::remove(temp_path, error);
+        return;
+    }
+
+    std::filesystem::rename(temp_path, path, error);
+    if (error) std::filesystem::remove(temp_path, error);
+}
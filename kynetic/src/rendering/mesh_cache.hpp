@@ -0,0 +1,45 @@
+//
+// Created by kenny on 12/1/25.
+//
+
+#pragma once
+
+namespace kynetic
+{
+
+// Output of the cluster LOD build, everything the GPU needs besides the source geometry.
+struct MeshClusterData
+{
+    std::vector<ClusterData> clusters;
+    std::vector<MeshletData> meshlets;
+    std::vector<LODGroupData> lod_groups;
+    std::vector<uint16_t> meshlet_vertices;   // packed, see MeshletData::vertex_index_bits
+    std::vector<uint16_t> meshlet_triangles;  // three 5-bit local indices per triangle
+
+    // Three 16-bit offsets from MeshletData::position_origin per meshlet vertex, empty unless QUANTIZE_CLUSTER_POSITIONS.
+    std::vector<uint16_t> meshlet_positions;
+    float position_step{0.f};
+
+    glm::vec3 bounds_min{0.f};
+    float bounds_step{0.f};
+
+    uint32_t max_lod_level{0};
+
+    glm::vec3 centroid{0.f};
+    float radius{0.f};
+};
+
+namespace mesh_cache
+{
+
+// Bump whenever the build output or the file layout changes, old entries are then ignored.
+constexpr uint32_t VERSION = 4;
+
+std::filesystem::path get_path(uint64_t key);
+
+bool load(uint64_t key, MeshClusterData& data);
+void store(uint64_t key, const MeshClusterData& data);
+
+}  // namespace mesh_cache
+
+}  // namespace kynetic
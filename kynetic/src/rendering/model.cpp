@@ -2,16 +2,28 @@
 // Created by kenny on 11/14/25.
 //
 
+#include "asset_file.hpp"
 #include "mesh.hpp"
 #include "texture.hpp"
+#include "texture_cache.hpp"
+#include "texture_compression.hpp"
 #include "material.hpp"
 #include "model.hpp"
+#include "upload_batch.hpp"
 
+#include "core/device.hpp"
 #include "core/engine.hpp"
+#include "core/hash.hpp"
+#include "core/mapped_file.hpp"
 #include "core/resource_manager.hpp"
+#include "core/thread_pool.hpp"
 
 #include "stb_image.h"
 
+#include <condition_variable>
+#include <mutex>
+#include <unordered_set>
+
 KX_DISABLE_WARNING_PUSH
 KX_DISABLE_WARNING_CONVERSION
 KX_DISABLE_WARNING_SIGNED_UNSIGNED_ASSIGNMENT_MISMATCH
@@ -55,326 +67,1198 @@ VkSamplerMipmapMode extract_mipmap_mode(fastgltf::Filter filter)
     }
 }
 
-Model::Model(const std::filesystem::path& path) : Resource(Type::Model, path.string())
+// Either bytes inside a loaded or mapped buffer, or an external file that's only opened once the image is decoded.
+struct ImageSource
 {
-    constexpr auto options = fastgltf::Options::LoadExternalBuffers | fastgltf::Options::LoadExternalImages |
-                             fastgltf::Options::DecomposeNodeMatrices;
-    auto file = fastgltf::GltfDataBuffer::FromPath(path);
+    std::filesystem::path file_path;
+    size_t file_offset{0};
+    const stbi_uc* bytes{nullptr};
+    int size{0};
+};
 
-    fastgltf::Asset asset;
-    fastgltf::Parser parser;
+struct TextureRequest
+{
+    size_t texture_index;
+    texture_compression::TextureUsage usage;
+};
 
-    fastgltf::Expected<fastgltf::Asset> loaded_asset = parser.loadGltf(file.get(), path.parent_path(), options);
-    KX_ASSERT_MSG(loaded_asset.error() == fastgltf::Error::None, "failed to load gltf ({} - {}): {}", path.parent_path().string(), path.string(), fastgltf::getErrorMessage(loaded_asset.error()));
+static ImageSource get_image_source(const std::filesystem::path& directory,
+                                    const fastgltf::Asset& asset,
+                                    const fastgltf::Image& image)
+{
+    ImageSource source;
 
-    asset = std::move(loaded_asset.get());
+    std::visit(fastgltf::visitor{
+                   [](auto&) {},
+                   [&](const fastgltf::sources::URI& file_path)
+                   {
+                       KX_ASSERT(file_path.uri.isLocalPath());  // We're only capable of loading local files.
 
-    auto validation = fastgltf::validate(asset);
-    KX_ASSERT_MSG(validation == fastgltf::Error::None, "glTF validation failed: {}", fastgltf::getErrorMessage(validation));
+                       source.file_path = directory / file_path.uri.fspath();
+                       source.file_offset = file_path.fileByteOffset;
+                   },
+                   [&](const fastgltf::sources::Array& vector)
+                   {
+                       source.bytes = reinterpret_cast<const stbi_uc*>(vector.bytes.data());
+                       source.size = static_cast<int>(vector.bytes.size());
+                   },
+                   [&](const fastgltf::sources::BufferView& view)
+                   {
+                       auto& bufferView = asset.bufferViews[view.bufferViewIndex];
+                       auto& buffer = asset.buffers[bufferView.bufferIndex];
+                       // Embedded GLB buffers are loaded into an Array, external ones are mapped by map_buffers.
+                       auto set_bytes = [&](const auto& bytes)
+                       {
+                           source.bytes = reinterpret_cast<const stbi_uc*>(bytes.bytes.data() + bufferView.byteOffset);
+                           source.size = static_cast<int>(bufferView.byteLength);
+                       };
+                       std::visit(fastgltf::visitor{[](auto&) {},
+                                                    [&](const fastgltf::sources::Array& vector) { set_bytes(vector); },
+                                                    [&](const fastgltf::sources::ByteView& bytes) { set_bytes(bytes); }},
+                                  buffer.data);
+                   },
+               },
+               image.data);
 
-    std::vector<uint32_t> indices;
-    std::vector<glm::vec4> positions;
-    std::vector<Vertex> vertices;
+    return source;
+}
 
-    auto load_texture = [&](const fastgltf::TextureInfo& texture_info, VkFormat image_format) -> std::shared_ptr<Texture>
+// External buffers are mapped instead of read, the importer only faults in the pages its accessors touch and the
+// mappings are released with the bake. Returns false if a buffer can't be mapped.
+static bool map_buffers(const std::filesystem::path& directory, fastgltf::Asset& asset, std::vector<MappedFile>& mappings)
+{
+    mappings.reserve(asset.buffers.size());
+    for (fastgltf::Buffer& buffer : asset.buffers)
     {
-        auto& texture_asset = asset.textures[texture_info.textureIndex];
-        const std::filesystem::path texture_path = path / "texture" / std::to_string(texture_info.textureIndex);
-        std::shared_ptr<Texture> texture = Engine::get().resources().find<Texture>(texture_path);
-        if (texture) return texture;
+        const auto* uri = std::get_if<fastgltf::sources::URI>(&buffer.data);
+        if (!uri) continue;
 
-        fastgltf::Image& image = asset.images[texture_asset.imageIndex.value()];
-        fastgltf::Sampler& sampler = asset.samplers[texture_asset.samplerIndex.value()];
+        if (!uri->uri.isLocalPath())
+        {
+            fmt::print(stderr, "Buffer '{}' is not a local file\n", uri->uri.string());
+            return false;
+        }
 
-        VkSamplerCreateInfo sampler_create_info{.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO, .pNext = nullptr};
-        sampler_create_info.maxLod = VK_LOD_CLAMP_NONE;
-        sampler_create_info.minLod = 0;
+        const std::filesystem::path buffer_path = directory / uri->uri.fspath();
+        const size_t offset = uri->fileByteOffset;
+        const fastgltf::MimeType mime_type = uri->mimeType;
 
-        sampler_create_info.magFilter = extract_filter(sampler.magFilter.value_or(fastgltf::Filter::Nearest));
-        sampler_create_info.minFilter = extract_filter(sampler.minFilter.value_or(fastgltf::Filter::Nearest));
+        const MappedFile& file = mappings.emplace_back(buffer_path);
+        if (!file.is_open() || offset > file.size() || buffer.byteLength > file.size() - offset)
+        {
+            fmt::print(stderr, "Failed to map buffer '{}'\n", buffer_path.string());
+            return false;
+        }
 
-        sampler_create_info.mipmapMode = extract_mipmap_mode(sampler.minFilter.value_or(fastgltf::Filter::Nearest));
+        const auto* bytes = reinterpret_cast<const std::byte*>(file.data() + offset);
+        buffer.data = fastgltf::sources::ByteView{fastgltf::span<const std::byte>(bytes, buffer.byteLength), mime_type};
+    }
 
-        int width, height, nrChannels;
-        unsigned char* data;
+    return true;
+}
 
-        std::visit(
-            fastgltf::visitor{
-                [](auto&) {},
-                [&](fastgltf::sources::URI& file_path)
-                {
-                    KX_ASSERT(file_path.fileByteOffset == 0);  // We don't support offsets with stbi.
-                    KX_ASSERT(file_path.uri.isLocalPath());    // We're only capable of loading local files.
+// Reads only the image header, used to account for the decoded size before decoding.
+static size_t get_decoded_size(const ImageSource& source)
+{
+    int width = 0, height = 0, channels = 0;
+    int result = 0;
+    if (source.bytes)
+    {
+        result = stbi_info_from_memory(source.bytes, source.size, &width, &height, &channels);
+    }
+    else
+    {
+        // Mapping only reads the header pages, the rest of the file stays untouched until the decode.
+        const MappedFile file(source.file_path);
+        if (file.is_open() && source.file_offset < file.size())
+            result = stbi_info_from_memory(file.data() + source.file_offset,
+                                           static_cast<int>(file.size() - source.file_offset),
+                                           &width,
+                                           &height,
+                                           &channels);
+    }
 
-                    const std::string path(file_path.uri.path());  // Thanks C++.
-                    data = stbi_load(path.c_str(), &width, &height, &nrChannels, 4);
-                },
-                [&](fastgltf::sources::Array& vector)
-                {
-                    data = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(vector.bytes.data()),
-                                                 static_cast<int>(vector.bytes.size()),
-                                                 &width,
-                                                 &height,
-                                                 &nrChannels,
-                                                 4);
-                },
-                [&](fastgltf::sources::BufferView& view)
-                {
-                    auto& bufferView = asset.bufferViews[view.bufferViewIndex];
-                    auto& buffer = asset.buffers[bufferView.bufferIndex];
-                    // Yes, we've already loaded every buffer into some GL buffer. However, with GL it's simpler
-                    // to just copy the buffer data again for the texture. Besides, this is just an example.
-                    std::visit(
-                        fastgltf::visitor{
-                            // We only care about VectorWithMime here, because we specify LoadExternalBuffers, meaning
-                            // all buffers are already loaded into a vector.
-                            [](auto&) {},
-                            [&](fastgltf::sources::Array& vector)
-                            {
-                                data = stbi_load_from_memory(
-                                    reinterpret_cast<const stbi_uc*>(vector.bytes.data() + bufferView.byteOffset),
-                                    static_cast<int>(bufferView.byteLength),
-                                    &width,
-                                    &height,
-                                    &nrChannels,
-                                    4);
-                            }},
-                        buffer.data);
-                },
-            },
-            image.data);
-
-        VkExtent3D extent;
-        extent.width = static_cast<uint32_t>(width);
-        extent.height = static_cast<uint32_t>(height);
-        extent.depth = 1;
-
-        texture = Engine::get().resources().load<Texture>(texture_path,
-                                                          data,
-                                                          extent,
-                                                          image_format,
-                                                          VK_IMAGE_USAGE_SAMPLED_BIT,
-                                                          sampler_create_info);
-
-        stbi_image_free(data);
-
-        return texture;
+    // The CPU built mip chain adds another third on top of level 0.
+    return result ? static_cast<size_t>(width) * static_cast<size_t>(height) * 4 * 4 / 3 : 0;
+}
+
+static VkSamplerCreateInfo make_sampler_create_info(VkFilter mag_filter, VkFilter min_filter, VkSamplerMipmapMode mipmap_mode)
+{
+    VkSamplerCreateInfo sampler_create_info{.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO, .pNext = nullptr};
+    sampler_create_info.maxLod = VK_LOD_CLAMP_NONE;
+    sampler_create_info.minLod = 0;
+
+    sampler_create_info.magFilter = mag_filter;
+    sampler_create_info.minFilter = min_filter;
+
+    sampler_create_info.mipmapMode = mipmap_mode;
+
+    return sampler_create_info;
+}
+
+static VkSamplerCreateInfo get_sampler_create_info(const fastgltf::Asset& asset, const fastgltf::Texture& texture_asset)
+{
+    const fastgltf::Sampler& sampler = asset.samplers[texture_asset.samplerIndex.value()];
+
+    return make_sampler_create_info(extract_filter(sampler.magFilter.value_or(fastgltf::Filter::Nearest)),
+                                    extract_filter(sampler.minFilter.value_or(fastgltf::Filter::Nearest)),
+                                    extract_mipmap_mode(sampler.minFilter.value_or(fastgltf::Filter::Nearest)));
+}
+
+// A glTF texture is imported once per usage it's sampled with, each usage encodes the image in its own channel layout.
+static std::filesystem::path get_texture_path(const std::filesystem::path& path,
+                                              size_t texture_index,
+                                              texture_compression::TextureUsage usage)
+{
+    using texture_compression::TextureUsage;
+
+    const char* usage_name = "color";
+    if (usage == TextureUsage::Normal) usage_name = "normal";
+    else if (usage == TextureUsage::MetalRoughness) usage_name = "metal_roughness";
+    else if (usage == TextureUsage::Emissive) usage_name = "emissive";
+
+    return path / "texture" / std::to_string(texture_index) / usage_name;
+}
+
+// Identical images are only uploaded once if they are sampled the same way too.
+static uint64_t get_texture_content_key(uint64_t data_key, const VkSamplerCreateInfo& sampler_create_info)
+{
+    uint64_t key = hash_combine(data_key, sampler_create_info.magFilter);
+    key = hash_combine(key, sampler_create_info.minFilter);
+    key = hash_combine(key, sampler_create_info.mipmapMode);
+    return key;
+}
+
+// Materials are nothing but their textures, so materials over deduplicated textures collapse as well.
+static uint64_t get_material_content_key(const Texture& albedo,
+                                         const Texture& normal,
+                                         const Texture& metal_roughness,
+                                         const Texture& emissive)
+{
+    uint64_t key = hash_combine(albedo.id, normal.id);
+    key = hash_combine(key, metal_roughness.id);
+    key = hash_combine(key, emissive.id);
+    return key;
+}
+
+// A mesh owns its material, the same geometry under another material needs its own resource.
+static uint64_t get_mesh_content_key(uint64_t geometry_key, const Material& material)
+{
+    return hash_combine(geometry_key, material.id);
+}
+
+// Block rows handed to each encode task, small enough to spread a single large texture over the pool.
+constexpr uint32_t ENCODE_BLOCK_ROWS_PER_TASK = 16;
+
+// Builds the full mip chain on the CPU, so it ends up in the texture cache together with the encoded level 0. Block
+// compressed formats can't be blitted on the GPU anyway.
+static void build_texture_data(ThreadPool& threads,
+                               const uint8_t* rgba,
+                               uint32_t width,
+                               uint32_t height,
+                               texture_compression::TextureUsage usage,
+                               bool compress,
+                               TextureData& data)
+{
+    const texture_compression::FormatChoice choice =
+        compress ? texture_compression::choose_format(usage, rgba, width, height) : texture_compression::FormatChoice{};
+
+    const uint32_t level_count = texture_compression::get_level_count(width, height);
+
+    // RGBA8 source of every level, level 0 is the decoded image itself.
+    std::vector<std::vector<uint8_t>> level_pixels(level_count - 1);
+    std::vector<const uint8_t*> level_sources(level_count);
+    level_sources[0] = rgba;
+    for (uint32_t level = 1; level < level_count; ++level)
+    {
+        texture_compression::downsample(usage,
+                                        level_sources[level - 1],
+                                        std::max(width >> (level - 1), 1u),
+                                        std::max(height >> (level - 1), 1u),
+                                        level_pixels[level - 1]);
+        level_sources[level] = level_pixels[level - 1].data();
+    }
+
+    data.format = choice.format;
+    data.swizzle = choice.swizzle;
+    data.extent = {width, height, 1};
+    data.levels.resize(level_count);
+
+    struct EncodeTask
+    {
+        uint32_t level;
+        uint32_t first_block_row;
+    };
+    std::vector<EncodeTask> tasks;
+
+    size_t offset = 0;
+    for (uint32_t level = 0; level < level_count; ++level)
+    {
+        const uint32_t level_width = std::max(width >> level, 1u);
+        const uint32_t level_height = std::max(height >> level, 1u);
+
+        data.levels[level] = {offset, texture_compression::get_level_size(choice.format, level_width, level_height)};
+        offset += data.levels[level].size;
+
+        const uint32_t block_rows = (level_height + 3) / 4;
+        for (uint32_t row = 0; row < block_rows; row += ENCODE_BLOCK_ROWS_PER_TASK) tasks.push_back({level, row});
+    }
+    data.pixels.resize(offset);
+
+    threads.parallel_for(tasks.size(),
+                         [&](size_t task_index)
+                         {
+                             const EncodeTask& task = tasks[task_index];
+                             texture_compression::encode(choice,
+                                                         level_sources[task.level],
+                                                         std::max(width >> task.level, 1u),
+                                                         std::max(height >> task.level, 1u),
+                                                         data.pixels.data() + data.levels[task.level].offset,
+                                                         task.first_block_row,
+                                                         ENCODE_BLOCK_ROWS_PER_TASK);
+                         });
+}
+
+// Fetches the texture from the cache, keyed on the encoded image bytes, or decodes and compresses it and fills the cache.
+// The cache key is also returned as content_key. Returns nullptr on success, otherwise the reason it failed.
+static const char* load_texture_data(ThreadPool& threads,
+                                     const ImageSource& source,
+                                     texture_compression::TextureUsage usage,
+                                     bool compress,
+                                     TextureData& data,
+                                     uint64_t& content_key)
+{
+    const stbi_uc* bytes = source.bytes;
+    int size = source.size;
+
+    // External images are only opened here, so at most the in flight decodes have their files mapped.
+    MappedFile file;
+    if (!bytes)
+    {
+        file = MappedFile(source.file_path);
+        if (!file.is_open() || source.file_offset >= file.size()) return "could not open file";
+
+        bytes = file.data() + source.file_offset;
+        size = static_cast<int>(file.size() - source.file_offset);
+    }
+
+    uint64_t key = hash_bytes(bytes, static_cast<size_t>(size), texture_cache::VERSION);
+    key = hash_combine(key, static_cast<uint64_t>(usage));
+    key = hash_combine(key, compress);
+    content_key = key;
+
+    if (texture_cache::load(key, data)) return nullptr;
+
+    int width, height, channels;
+    stbi_uc* pixels = stbi_load_from_memory(bytes, size, &width, &height, &channels, 4);
+    if (!pixels) return stbi_failure_reason();
+
+    build_texture_data(threads,
+                       pixels,
+                       static_cast<uint32_t>(width),
+                       static_cast<uint32_t>(height),
+                       usage,
+                       compress,
+                       data);
+    stbi_image_free(pixels);
+
+    texture_cache::store(key, data);
+
+    return nullptr;
+}
+
+// Decodes on the thread pool while the calling thread hands whatever has finished to on_loaded. Decoded pixels count
+// against decode_budget from the moment their decode is queued until on_loaded returned, they're released right after.
+static void load_textures(const std::filesystem::path& path,
+                          const fastgltf::Asset& asset,
+                          std::span<const TextureRequest> requests,
+                          ThreadPool& threads,
+                          bool compress,
+                          size_t decode_budget,
+                          const std::function<void(size_t, const TextureData&, uint64_t)>& on_loaded)
+{
+    struct DecodeJob
+    {
+        ImageSource source;
+        size_t decoded_size{0};
+
+        TextureData data;
+        uint64_t content_key{0};
+        const char* error{nullptr};
+    };
+
+    std::vector<DecodeJob> decode_jobs(requests.size());
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+        const fastgltf::Texture& texture_asset = asset.textures[requests[i].texture_index];
+
+        decode_jobs[i].source =
+            get_image_source(path.parent_path(), asset, asset.images[texture_asset.imageIndex.value()]);
+        decode_jobs[i].decoded_size = get_decoded_size(decode_jobs[i].source);
+    }
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<size_t> decoded;
+
+    size_t in_flight_size = 0;
+    size_t next_job = 0;
+    size_t finished_jobs = 0;
+
+    while (finished_jobs < decode_jobs.size())
+    {
+        std::vector<size_t> ready;
+        {
+            std::unique_lock lock(mutex);
+
+            // An image larger than the whole budget still has to go through, just on its own.
+            while (next_job < decode_jobs.size() &&
+                   (in_flight_size == 0 || in_flight_size + decode_jobs[next_job].decoded_size <= decode_budget))
+            {
+                in_flight_size += decode_jobs[next_job].decoded_size;
+                threads.submit(
+                    [&, job_index = next_job]
+                    {
+                        DecodeJob& job = decode_jobs[job_index];
+
+                        job.error = load_texture_data(threads,
+                                                      job.source,
+                                                      requests[job_index].usage,
+                                                      compress,
+                                                      job.data,
+                                                      job.content_key);
+
+                        // Notify under the lock, the loader may return as soon as it sees the last job.
+                        std::lock_guard job_lock(mutex);
+                        decoded.push_back(job_index);
+                        condition.notify_one();
+                    });
+                ++next_job;
+            }
+
+            condition.wait(lock, [&] { return !decoded.empty(); });
+            ready.swap(decoded);
+        }
+
+        for (const size_t job_index : ready)
+        {
+            const DecodeJob& job = decode_jobs[job_index];
+            const TextureRequest& request = requests[job_index];
+            const fastgltf::Texture& texture_asset = asset.textures[request.texture_index];
+
+            if (job.error)
+            {
+                fmt::print(stderr,
+                           "Failed to load texture {} of '{}': {}\n",
+                           request.texture_index,
+                           path.string(),
+                           job.error);
+                continue;
+            }
+
+            const VkSamplerCreateInfo sampler_create_info = get_sampler_create_info(asset, texture_asset);
+            on_loaded(job_index, job.data, get_texture_content_key(job.content_key, sampler_create_info));
+        }
+
+        std::lock_guard lock(mutex);
+        for (const size_t job_index : ready)
+        {
+            DecodeJob& job = decode_jobs[job_index];
+
+            job.data = {};
+
+            in_flight_size -= job.decoded_size;
+        }
+        finished_jobs += ready.size();
+    }
+}
+
+// MikkTSpace asks for every corner of every face several times over, so the corners are gathered into flat arrays up front
+// and the callbacks only index into them.
+static void generate_mikktspace_tangents(std::span<const uint32_t> indices,
+                                         std::span<const glm::vec3> positions,
+                                         std::span<ImportVertex> vertices)
+{
+    struct Context
+    {
+        int face_count;
+        const glm::vec3* positions;
+        const glm::vec3* normals;
+        const glm::vec2* uvs;
+        glm::vec4* tangents;
+    };
+
+    const size_t corner_count = indices.size() / 3 * 3;
+    std::vector<glm::vec3> corner_positions(corner_count);
+    std::vector<glm::vec3> corner_normals(corner_count);
+    std::vector<glm::vec2> corner_uvs(corner_count);
+    std::vector<glm::vec4> corner_tangents(corner_count);
+    for (size_t i = 0; i < corner_count; ++i)
+    {
+        const ImportVertex& vertex = vertices[indices[i]];
+        corner_positions[i] = positions[indices[i]];
+        corner_normals[i] = vertex.normal;
+        corner_uvs[i] = glm::vec2(vertex.uv_x, vertex.uv_y);
+    }
+
+    Context context{static_cast<int>(corner_count / 3),
+                    corner_positions.data(),
+                    corner_normals.data(),
+                    corner_uvs.data(),
+                    corner_tangents.data()};
+
+    SMikkTSpaceInterface mikkTSpaceInterface{};
+    mikkTSpaceInterface.m_getNumFaces = [](SMikkTSpaceContext const* pContext) -> int
+    { return static_cast<const Context*>(pContext->m_pUserData)->face_count; };
+    mikkTSpaceInterface.m_getNumVerticesOfFace = [](SMikkTSpaceContext const*, int) -> int { return 3; };
+    mikkTSpaceInterface.m_getPosition = [](SMikkTSpaceContext const* pContext, float* fvPosOut, int iFace, int iVert)
+    {
+        const auto* context = static_cast<const Context*>(pContext->m_pUserData);
+        const glm::vec3& position = context->positions[iFace * 3 + iVert];
+        fvPosOut[0] = position.x;
+        fvPosOut[1] = position.y;
+        fvPosOut[2] = position.z;
+    };
+    mikkTSpaceInterface.m_getNormal = [](SMikkTSpaceContext const* pContext, float* fvNormOut, int iFace, int iVert)
+    {
+        const auto* context = static_cast<const Context*>(pContext->m_pUserData);
+        const glm::vec3& normal = context->normals[iFace * 3 + iVert];
+        fvNormOut[0] = normal.x;
+        fvNormOut[1] = normal.y;
+        fvNormOut[2] = normal.z;
+    };
+    mikkTSpaceInterface.m_getTexCoord = [](SMikkTSpaceContext const* pContext, float* fvTexcOut, int iFace, int iVert)
+    {
+        const auto* context = static_cast<const Context*>(pContext->m_pUserData);
+        const glm::vec2& uv = context->uvs[iFace * 3 + iVert];
+        fvTexcOut[0] = uv.x;
+        fvTexcOut[1] = uv.y;
+    };
+    mikkTSpaceInterface.m_setTSpaceBasic =
+        [](SMikkTSpaceContext const* pContext, float const* fvTangent, float fSign, int iFace, int iVert)
+    {
+        const auto* context = static_cast<const Context*>(pContext->m_pUserData);
+        context->tangents[iFace * 3 + iVert] = glm::vec4(fvTangent[0], fvTangent[1], fvTangent[2], fSign);
+    };
+
+    SMikkTSpaceContext mikkTSpaceContext{};
+    mikkTSpaceContext.m_pInterface = &mikkTSpaceInterface;
+    mikkTSpaceContext.m_pUserData = &context;
+
+    genTangSpaceDefault(&mikkTSpaceContext);
+
+    // Corners sharing a vertex got the same tangent unless MikkTSpace split it, the last one wins like before.
+    for (size_t i = 0; i < corner_count; ++i) vertices[indices[i]].tangent = corner_tangents[i];
+}
+
+// Accumulates the UV gradients of every triangle on its vertices and orthogonalizes them against the normal, see
+// "Computing Tangent Space Basis Vectors for an Arbitrary Mesh" (Lengyel 2001). Close to MikkTSpace on well behaved UVs,
+// without its vertex welding and splitting.
+static void generate_fast_tangents(std::span<const uint32_t> indices,
+                                   std::span<const glm::vec3> positions,
+                                   std::span<ImportVertex> vertices)
+{
+    std::vector<glm::vec3> tangents(vertices.size(), glm::vec3(0.f));
+    std::vector<glm::vec3> bitangents(vertices.size(), glm::vec3(0.f));
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        const uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+
+        const glm::vec3 edge1 = positions[b] - positions[a];
+        const glm::vec3 edge2 = positions[c] - positions[a];
+        const glm::vec2 uv1 = glm::vec2(vertices[b].uv_x - vertices[a].uv_x, vertices[b].uv_y - vertices[a].uv_y);
+        const glm::vec2 uv2 = glm::vec2(vertices[c].uv_x - vertices[a].uv_x, vertices[c].uv_y - vertices[a].uv_y);
+
+        const float determinant = uv1.x * uv2.y - uv2.x * uv1.y;
+        if (std::abs(determinant) < FLT_MIN) continue;
+
+        // Left unnormalized, so larger triangles weigh more.
+        const float r = 1.f / determinant;
+        const glm::vec3 tangent = (edge1 * uv2.y - edge2 * uv1.y) * r;
+        const glm::vec3 bitangent = (edge2 * uv1.x - edge1 * uv2.x) * r;
+        for (const uint32_t v : {a, b, c})
+        {
+            tangents[v] += tangent;
+            bitangents[v] += bitangent;
+        }
+    }
+
+    for (size_t v = 0; v < vertices.size(); ++v)
+    {
+        const glm::vec3 normal = vertices[v].normal;
+        glm::vec3 tangent = tangents[v] - normal * glm::dot(normal, tangents[v]);
+
+        // Vertices without usable UVs get any tangent perpendicular to the normal.
+        if (glm::dot(tangent, tangent) < FLT_MIN)
+            tangent = glm::cross(normal, std::abs(normal.x) < 0.9f ? glm::vec3(1.f, 0.f, 0.f) : glm::vec3(0.f, 1.f, 0.f));
+
+        tangent = glm::normalize(tangent);
+        const float sign = glm::dot(glm::cross(normal, tangent), bitangents[v]) < 0.f ? -1.f : 1.f;
+        vertices[v].tangent = glm::vec4(tangent, sign);
+    }
+}
+
+// Copies a whole attribute into a scratch stream. fastgltf memcpys accessors that already are tightly packed T and converts
+// normalized integer and quantized ones while copying. Attributes that don't cover every vertex are left out.
+template <typename T>
+static void copy_attribute(const fastgltf::Asset& asset,
+                           const fastgltf::Primitive& p,
+                           std::string_view name,
+                           size_t vertex_count,
+                           std::vector<T>& stream)
+{
+    const auto* attribute = p.findAttribute(name);
+    if (attribute == p.attributes.end()) return;
+
+    const fastgltf::Accessor& accessor = asset.accessors[attribute->accessorIndex];
+    if (accessor.count != vertex_count) return;
+
+    stream.resize(vertex_count);
+    fastgltf::copyFromAccessor<T>(asset, accessor, stream.data());
+}
+
+static void load_primitive(const fastgltf::Asset& asset,
+                           const fastgltf::Primitive& p,
+                           std::vector<uint32_t>& indices,
+                           std::vector<glm::vec3>& positions,
+                           std::vector<ImportVertex>& vertices)
+{
+    const size_t initial_vtx = vertices.size();
+
+    // load indices
+    {
+        const fastgltf::Accessor& index_accessor = asset.accessors[p.indicesAccessor.value()];
+        const size_t initial_index = indices.size();
+        indices.resize(initial_index + index_accessor.count);
+
+        fastgltf::copyFromAccessor<std::uint32_t>(asset, index_accessor, indices.data() + initial_index);
+        if (initial_vtx > 0)
+            for (size_t i = initial_index; i < indices.size(); ++i) indices[i] += static_cast<uint32_t>(initial_vtx);
+    }
+
+    // load vertex positions
+    const fastgltf::Accessor& position_accessor = asset.accessors[p.findAttribute("POSITION")->accessorIndex];
+    const size_t vertex_count = position_accessor.count;
+    positions.resize(initial_vtx + vertex_count);
+    fastgltf::copyFromAccessor<glm::vec3>(asset, position_accessor, positions.data() + initial_vtx);
+
+    // The remaining attributes go through SoA scratch streams and are interleaved in a single pass.
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec4> tangents;
+    std::vector<glm::vec4> colors;
+    std::vector<glm::vec3> colors_rgb;
+    copy_attribute(asset, p, "NORMAL", vertex_count, normals);
+    copy_attribute(asset, p, "TEXCOORD_0", vertex_count, uvs);
+    copy_attribute(asset, p, "TANGENT", vertex_count, tangents);
+
+    // COLOR_0 may come without alpha.
+    if (const auto* color = p.findAttribute("COLOR_0"); color != p.attributes.end())
+    {
+        if (asset.accessors[color->accessorIndex].type == fastgltf::AccessorType::Vec3)
+            copy_attribute(asset, p, "COLOR_0", vertex_count, colors_rgb);
+        else
+            copy_attribute(asset, p, "COLOR_0", vertex_count, colors);
+    }
+
+    vertices.resize(initial_vtx + vertex_count);
+    ImportVertex* out = vertices.data() + initial_vtx;
+    for (size_t i = 0; i < vertex_count; ++i)
+    {
+        ImportVertex& vertex = out[i];
+        vertex.normal = normals.empty() ? glm::vec3(1.f, 0.f, 0.f) : normals[i];
+        vertex.uv_x = uvs.empty() ? 0.f : uvs[i].x;
+        vertex.uv_y = uvs.empty() ? 0.f : uvs[i].y;
+        vertex.tangent = tangents.empty() ? glm::vec4(0.f) : tangents[i];
+        vertex.color = !colors.empty() ? colors[i] : !colors_rgb.empty() ? glm::vec4(colors_rgb[i], 1.f) : glm::vec4(1.f);
+    }
+
+    // generate tangents when they're missing
+    if (tangents.empty())
+    {
+        if constexpr (EXACT_TANGENTS)
+            generate_mikktspace_tangents(indices, positions, vertices);
+        else
+            generate_fast_tangents(indices, positions, vertices);
+    }
+}
+
+// Baked files are keyed on the glTF file itself rather than its contents, hashing a whole scene costs as much as importing
+// it. Buffers and images next to it are assumed to change together with the glTF.
+static uint64_t get_asset_key(const std::filesystem::path& path, bool compress)
+{
+    std::error_code error;
+    const uint64_t file_size = std::filesystem::file_size(path, error);
+    const auto write_time = std::filesystem::last_write_time(path, error).time_since_epoch().count();
+
+    uint64_t key = hash_combine(asset_file::VERSION, mesh_cache::VERSION);
+    key = hash_combine(key, texture_cache::VERSION);
+    key = hash_combine(key, sizeof(Vertex));
+    key = hash_combine(key, sizeof(ClusterData));
+    key = hash_combine(key, sizeof(MeshletData));
+    key = hash_combine(key, compress);
+    key = hash_combine(key, OPTIMIZE_VERTEX_ORDER);
+    key = hash_combine(key, EXACT_TANGENTS);
+    key = hash_combine(key, QUANTIZE_CLUSTER_POSITIONS);
+
+    const std::string path_string = path.string();
+    key = hash_combine(key, hash_bytes(path_string.data(), path_string.size()));
+    key = hash_combine(key, file_size);
+    key = hash_combine(key, static_cast<uint64_t>(write_time));
+
+    return key;
+}
+
+// Instances without one of the attributes keep its identity value.
+static void load_instances(const fastgltf::Asset& asset, const fastgltf::Node& node, std::vector<Model::Instance>& instances)
+{
+    size_t count = 0;
+    for (const auto& attribute : node.instancingAttributes)
+        count = std::max(count, asset.accessors[attribute.accessorIndex].count);
+    instances.assign(count, Model::Instance{});
+
+    auto* translations = node.findInstancingAttribute("TRANSLATION");
+    if (translations != node.instancingAttributes.end())
+    {
+        fastgltf::iterateAccessorWithIndex<glm::vec3>(asset,
+                                                      asset.accessors[translations->accessorIndex],
+                                                      [&](glm::vec3 v, size_t index) { instances[index].translation = v; });
+    }
+
+    auto* rotations = node.findInstancingAttribute("ROTATION");
+    if (rotations != node.instancingAttributes.end())
+    {
+        fastgltf::iterateAccessorWithIndex<glm::vec4>(asset,
+                                                      asset.accessors[rotations->accessorIndex],
+                                                      [&](glm::vec4 v, size_t index)
+                                                      { instances[index].rotation = glm::quat(v.w, v.x, v.y, v.z); });
+    }
+
+    auto* scales = node.findInstancingAttribute("SCALE");
+    if (scales != node.instancingAttributes.end())
+    {
+        fastgltf::iterateAccessorWithIndex<glm::vec3>(asset,
+                                                      asset.accessors[scales->accessorIndex],
+                                                      [&](glm::vec3 v, size_t index) { instances[index].scale = v; });
+    }
+}
+
+static asset_file::TextureRecord write_texture_record(asset_file::Writer& writer,
+                                                      const std::filesystem::path& texture_path,
+                                                      const VkSamplerCreateInfo& sampler_create_info,
+                                                      const TextureData& data,
+                                                      uint64_t content_key,
+                                                      std::vector<TextureLevel>& levels)
+{
+    asset_file::TextureRecord record{};
+    record.path = writer.add_string(texture_path.string());
+    record.content_key = content_key;
+    record.format = data.format;
+    record.swizzle = data.swizzle;
+    record.extent = data.extent;
+    record.mag_filter = sampler_create_info.magFilter;
+    record.min_filter = sampler_create_info.minFilter;
+    record.mipmap_mode = sampler_create_info.mipmapMode;
+    record.first_level = static_cast<uint32_t>(levels.size());
+    record.level_count = static_cast<uint32_t>(data.levels.size());
+    record.pixels = writer.write(std::span<const uint8_t>(data.pixels));
+
+    levels.insert(levels.end(), data.levels.begin(), data.levels.end());
+
+    return record;
+}
+
+static asset_file::Section write_vertices(asset_file::Writer& writer, const GeometryStream& stream, size_t stride)
+{
+    if (stream.empty()) return {};
+    return writer.write(std::span<const uint8_t>(geometry_codec::encode_vertices(stream.data, stream.size, stride)));
+}
+
+static asset_file::Section write_indices(asset_file::Writer& writer, const GeometryStream& stream, size_t index_size)
+{
+    if (stream.empty()) return {};
+    return writer.write(std::span<const uint8_t>(geometry_codec::encode_indices(stream.data, stream.size, index_size)));
+}
+
+static asset_file::MeshRecord write_mesh_record(asset_file::Writer& writer,
+                                                const std::filesystem::path& mesh_path,
+                                                uint32_t mesh_index,
+                                                uint32_t material,
+                                                uint64_t content_key,
+                                                const MeshDataView& data)
+{
+    asset_file::MeshRecord record{};
+    record.path = writer.add_string(mesh_path.string());
+    record.mesh_index = mesh_index;
+    record.material = material;
+    record.content_key = content_key;
+    record.max_lod_level = data.max_lod_level;
+    record.radius = data.radius;
+    record.centroid = data.centroid;
+    record.position_step = data.position_step;
+    record.bounds_min = data.bounds_min;
+    record.bounds_step = data.bounds_step;
+    record.indices = write_indices(writer, data.indices, sizeof(uint32_t));
+    record.short_indices = write_indices(writer, data.short_indices, sizeof(uint16_t));
+    record.positions = write_vertices(writer, data.positions, sizeof(glm::vec3));
+    record.vertices = write_vertices(writer, data.vertices, sizeof(Vertex));
+    record.meshlets = writer.write(data.meshlets);
+    record.clusters = writer.write(data.clusters);
+    // The 16-bit meshlet streams are encoded two values at a time to fit the vertex codec's 4 byte stride.
+    record.meshlet_vertices = write_vertices(writer, data.meshlet_vertices, sizeof(uint32_t));
+    record.meshlet_triangles = write_vertices(writer, data.meshlet_triangles, sizeof(uint32_t));
+    record.meshlet_positions = write_vertices(writer, data.meshlet_positions, sizeof(uint32_t));
+
+    return record;
+}
+
+// Geometry sections hold geometry_codec streams, they're decoded into staging memory on flush.
+static GeometryStream read_stream(const asset_file::Reader& reader, asset_file::Section section)
+{
+    if (section.size == 0) return {};
+    return geometry_codec::make_stream(reader.get<uint8_t>(section));
+}
+
+bool Model::load_asset(const std::filesystem::path& path, uint64_t key, std::vector<uint8_t>&& memory)
+{
+    asset_file::Reader reader;
+    if (memory.empty() ? !reader.open(key) : !reader.open(key, std::move(memory))) return false;
+
+    ResourceManager& resources = Engine::get().resources();
+
+    // Every section is copied straight from the mapping into staging memory, the reader has to outlive the last flush.
+    UploadBatch uploads;
+
+    const std::span<const TextureLevel> levels = reader.get_levels();
+    for (const asset_file::TextureRecord& record : reader.get_textures())
+    {
+        TextureDataView data;
+        data.format = record.format;
+        data.swizzle = record.swizzle;
+        data.extent = record.extent;
+        data.levels = levels.subspan(record.first_level, record.level_count);
+        data.pixels = reader.get<uint8_t>(record.pixels);
+
+        resources.load_unique<Texture>(std::filesystem::path(reader.get(record.path)),
+                                       record.content_key,
+                                       data,
+                                       VK_IMAGE_USAGE_SAMPLED_BIT,
+                                       make_sampler_create_info(record.mag_filter, record.min_filter, record.mipmap_mode),
+                                       uploads);
+    }
+
+    auto find_texture = [&](const asset_file::String& texture_path) -> std::shared_ptr<Texture>
+    {
+        std::shared_ptr<Texture> texture = resources.find<Texture>(std::filesystem::path(reader.get(texture_path)));
+        return texture ? texture : resources.find<Texture>("dev/missing");
     };
 
-    auto load_material = [&](size_t material_index) -> std::shared_ptr<Material>
+    std::vector<std::shared_ptr<Material>> materials;
+    materials.reserve(reader.get_materials().size());
+    for (const asset_file::MaterialRecord& record : reader.get_materials())
+    {
+        std::shared_ptr<Texture> albedo = find_texture(record.albedo);
+        std::shared_ptr<Texture> normal = find_texture(record.normal);
+        std::shared_ptr<Texture> metal_roughness = find_texture(record.metal_roughness);
+        std::shared_ptr<Texture> emissive = find_texture(record.emissive);
+
+        materials.push_back(
+            resources.load_unique<Material>(std::filesystem::path(reader.get(record.path)),
+                                            get_material_content_key(*albedo, *normal, *metal_roughness, *emissive),
+                                            albedo,
+                                            normal,
+                                            metal_roughness,
+                                            emissive));
+    }
+
+    const std::span<const asset_file::MeshRecord> mesh_records = reader.get_meshes();
+
+    std::vector<MeshDataView> mesh_views;
+    mesh_views.reserve(mesh_records.size());
+    for (const asset_file::MeshRecord& record : mesh_records)
+    {
+        MeshDataView& data = mesh_views.emplace_back();
+        data.indices = read_stream(reader, record.indices);
+        data.short_indices = read_stream(reader, record.short_indices);
+        data.positions = read_stream(reader, record.positions);
+        data.vertices = read_stream(reader, record.vertices);
+        data.meshlets = reader.get<MeshletData>(record.meshlets);
+        data.clusters = reader.get<ClusterData>(record.clusters);
+        data.meshlet_vertices = read_stream(reader, record.meshlet_vertices);
+        data.meshlet_triangles = read_stream(reader, record.meshlet_triangles);
+        data.meshlet_positions = read_stream(reader, record.meshlet_positions);
+        data.position_step = record.position_step;
+        data.bounds_min = record.bounds_min;
+        data.bounds_step = record.bounds_step;
+        data.max_lod_level = record.max_lod_level;
+        data.centroid = record.centroid;
+        data.radius = record.radius;
+    }
+
+    // Meshes that turn out to be duplicates don't allocate, reserving for them only leaves some headroom.
+    Mesh::reserve_geometry(mesh_views, uploads);
+
+    std::vector<std::shared_ptr<Mesh>> meshes;
+    meshes.reserve(mesh_records.size());
+    for (size_t i = 0; i < mesh_records.size(); i++)
+    {
+        const asset_file::MeshRecord& record = mesh_records[i];
+        meshes.push_back(resources.load_unique<Mesh>(std::filesystem::path(reader.get(record.path)),
+                                                     get_mesh_content_key(record.content_key, *materials[record.material]),
+                                                     record.mesh_index,
+                                                     mesh_views[i],
+                                                     materials[record.material],
+                                                     uploads));
+    }
+
+    uploads.flush();
+
+    const std::span<const asset_file::NodeRecord> node_records = reader.get_nodes();
+    const std::span<const uint32_t> node_meshes = reader.get_node_meshes();
+    const std::span<const asset_file::InstanceRecord> node_instances = reader.get_node_instances();
+
+    m_root.children.reserve(
+        static_cast<size_t>(std::ranges::count(node_records, asset_file::NO_PARENT, &asset_file::NodeRecord::parent)));
+
+    // Records are depth first, so parents already exist. Children are reserved exactly, the pointers stay valid.
+    std::vector<Node*> nodes(node_records.size());
+    for (size_t i = 0; i < node_records.size(); ++i)
+    {
+        const asset_file::NodeRecord& record = node_records[i];
+        Node& parent = record.parent == asset_file::NO_PARENT ? m_root : *nodes[record.parent];
+
+        Node& node = parent.children.emplace_back();
+        node.children.reserve(record.child_count);
+        node.translation = record.translation;
+        node.rotation = record.rotation;
+        node.scale = record.scale;
+        node.parent = &parent;
+
+        for (const uint32_t mesh : node_meshes.subspan(record.first_mesh, record.mesh_count))
+            node.meshes.push_back(meshes[mesh]);
+
+        node.instances.reserve(record.instance_count);
+        for (const asset_file::InstanceRecord& instance : node_instances.subspan(record.first_instance, record.instance_count))
+            node.instances.push_back({instance.translation, instance.rotation, instance.scale});
+
+        nodes[i] = &node;
+    }
+
+    return true;
+}
+
+Model::Model(const std::filesystem::path& path, size_t texture_decode_budget) : Resource(Type::Model, path.string())
+{
+    const bool compress = Engine::get().device().supports_bc_compression();
+    const uint64_t asset_key = get_asset_key(path, compress);
+    if (load_asset(path, asset_key)) return;
+
+    // Imports always go through the asset file, exactly as the offline baker would produce it.
+    if (bake(path, Engine::get().threads(), compress, texture_decode_budget) && load_asset(path, asset_key)) return;
+
+    // The cache is only a shortcut, when it can't be written (read-only directory, full disk) the asset is baked into
+    // memory instead. Only a glTF that doesn't import at all is fatal.
+    fmt::print(stderr, "Failed to cache '{}', importing it without the asset cache\n", path.string());
+
+    std::vector<uint8_t> memory;
+    const bool baked = bake(path, Engine::get().threads(), compress, texture_decode_budget, &memory);
+    KX_ASSERT_MSG(baked, "failed to import '{}'", path.string());
+
+    const bool loaded = load_asset(path, asset_key, std::move(memory));
+    KX_ASSERT_MSG(loaded, "failed to load imported asset of '{}'", path.string());
+}
+
+bool Model::bake(const std::filesystem::path& path,
+                 ThreadPool& threads,
+                 bool compress,
+                 size_t texture_decode_budget,
+                 std::vector<uint8_t>* memory)
+{
+    // External buffers and images are left as URIs, buffers are mapped below and images opened as they're decoded.
+    constexpr auto options = fastgltf::Options::DecomposeNodeMatrices;
+    auto file = fastgltf::GltfDataBuffer::FromPath(path);
+    if (file.error() != fastgltf::Error::None)
     {
-        const std::filesystem::path material_path = path / "material" / std::to_string(material_index);
-        const fastgltf::Material& material_asset = asset.materials[material_index];
-        std::shared_ptr<Material> material = Engine::get().resources().find<Material>(material_path);
-        if (material) return material;
+        fmt::print(stderr, "Failed to read '{}': {}\n", path.string(), fastgltf::getErrorMessage(file.error()));
+        return false;
+    }
 
-        std::shared_ptr<Texture> albedo =
-            material_asset.pbrData.baseColorTexture.has_value()
-                ? load_texture(material_asset.pbrData.baseColorTexture.value(), VK_FORMAT_R8G8B8A8_UNORM)
-                : Engine::get().resources().find<Texture>("dev/white");
+    fastgltf::Parser parser(fastgltf::Extensions::EXT_mesh_gpu_instancing);
 
-        std::shared_ptr<Texture> normal = material_asset.normalTexture.has_value()
-                                              ? load_texture(material_asset.normalTexture.value(), VK_FORMAT_R8G8B8A8_UNORM)
-                                              : Engine::get().resources().find<Texture>("dev/normal");
+    fastgltf::Expected<fastgltf::Asset> loaded_asset = parser.loadGltf(file.get(), path.parent_path(), options);
+    if (loaded_asset.error() != fastgltf::Error::None)
+    {
+        fmt::print(stderr,
+                   "Failed to load glTF '{}': {}\n",
+                   path.string(),
+                   fastgltf::getErrorMessage(loaded_asset.error()));
+        return false;
+    }
+
+    fastgltf::Asset loaded = std::move(loaded_asset.get());
+
+    std::vector<MappedFile> mapped_buffers;
+    if (!map_buffers(path.parent_path(), loaded, mapped_buffers)) return false;
+
+    const fastgltf::Asset& asset = loaded;
+
+    const fastgltf::Error validation = fastgltf::validate(asset);
+    if (validation != fastgltf::Error::None)
+    {
+        fmt::print(stderr, "glTF validation of '{}' failed: {}\n", path.string(), fastgltf::getErrorMessage(validation));
+        return false;
+    }
+
+    // Primitives are gathered first so their CPU work can run on the thread pool.
+    struct PrimitiveJob
+    {
+        std::filesystem::path path;
+        uint32_t mesh_index;
+        size_t material_index;
+        const fastgltf::Primitive* primitive;
 
-        std::shared_ptr<Texture> metal_roughness =
-            material_asset.pbrData.metallicRoughnessTexture.has_value()
-                ? load_texture(material_asset.pbrData.metallicRoughnessTexture.value(), VK_FORMAT_R8G8B8A8_UNORM)
-                : Engine::get().resources().find<Texture>("dev/black");
+        // Imported geometry, kept until the source job has built it.
+        std::vector<uint32_t> indices;
+        std::vector<glm::vec3> positions;
+        std::vector<ImportVertex> vertices;
+        uint64_t content_key{0};
 
-        std::shared_ptr<Texture> emissive = material_asset.emissiveTexture.has_value()
-                                                ? load_texture(material_asset.emissiveTexture.value(), VK_FORMAT_R8G8B8A8_UNORM)
-                                                : Engine::get().resources().find<Texture>("dev/black");
+        // First job with the same geometry, only that one builds and the others share its sections.
+        size_t source_job{0};
 
-        return Engine::get().resources().load<Material>(material_path, albedo, normal, metal_roughness, emissive);
+        MeshData data;
     };
 
-    uint32_t mesh_index = 0;
-    std::function<void(size_t, Node&)> traverse_node = [&](const size_t node_index, Node& parent_node)
+    std::vector<PrimitiveJob> jobs;
+    std::unordered_map<std::string, size_t> job_lookup;
+
+    asset_file::Writer writer(get_asset_key(path, compress), memory);
+
+    std::vector<asset_file::NodeRecord> node_records;
+    std::vector<uint32_t> node_mesh_records;
+    std::vector<asset_file::InstanceRecord> node_instance_records;
+    std::vector<Instance> instances;
+
+    // Records are written depth first, the loader relies on parents coming before their children.
+    std::function<void(size_t, uint32_t)> traverse_node = [&](const size_t node_index, const uint32_t parent_record)
     {
         auto& asset_node = asset.nodes[node_index];
-        Node& node = parent_node.children.emplace_back();
+
+        const uint32_t node_record = static_cast<uint32_t>(node_records.size());
+        asset_file::NodeRecord& record = node_records.emplace_back();
         std::visit(fastgltf::visitor{[&](const fastgltf::TRS& trs)
                                      {
-                                         node.translation = glm::make_vec3(trs.translation.data());
-                                         node.rotation = glm::make_quat(trs.rotation.data());
-                                         node.scale = glm::make_vec3(trs.scale.data());
+                                         record.translation = glm::make_vec3(trs.translation.data());
+                                         record.rotation = glm::make_quat(trs.rotation.data());
+                                         record.scale = glm::make_vec3(trs.scale.data());
                                      },
                                      [&](const fastgltf::math::fmat4x4&) { KX_ASSERT(false); }},
                    asset_node.transform);
-        node.parent = &parent_node;
+        record.parent = parent_record;
+        record.child_count = static_cast<uint32_t>(asset_node.children.size());
+        record.first_mesh = static_cast<uint32_t>(node_mesh_records.size());
+        record.first_instance = static_cast<uint32_t>(node_instance_records.size());
 
         if (asset_node.meshIndex.has_value())
         {
-            auto& mesh = asset.meshes[asset_node.meshIndex.value()];
-            auto name = mesh.name;
+            const size_t gltf_mesh_index = asset_node.meshIndex.value();
+            auto& mesh = asset.meshes[gltf_mesh_index];
+
+            if (!asset_node.instancingAttributes.empty())
+            {
+                load_instances(asset, asset_node, instances);
+                for (const Instance& instance : instances)
+                    node_instance_records.push_back({instance.translation, instance.rotation, instance.scale});
+                record.instance_count = static_cast<uint32_t>(instances.size());
+            }
 
+            // Keyed by the glTF mesh rather than its name, names are optional and not unique. Every node referencing the
+            // mesh shares one build, the scene draws the repeats as instances.
             for (size_t prim_index = 0; prim_index < mesh.primitives.size(); ++prim_index)
             {
                 auto& p = mesh.primitives[prim_index];
 
-                indices.clear();
-                positions.clear();
-                vertices.clear();
-
-                size_t initial_vtx = vertices.size();
+                const std::filesystem::path mesh_path =
+                    path / "mesh" / std::to_string(gltf_mesh_index) / std::to_string(prim_index);
 
-                // load indices
+                auto [it, inserted] = job_lookup.try_emplace(mesh_path.string(), jobs.size());
+                if (inserted)
                 {
-                    fastgltf::Accessor& indexaccessor = asset.accessors[p.indicesAccessor.value()];
-                    indices.reserve(indices.size() + indexaccessor.count);
-
-                    fastgltf::iterateAccessor<std::uint32_t>(asset,
-                                                             indexaccessor,
-                                                             [&](const std::uint32_t idx)
-                                                             { indices.push_back(static_cast<uint32_t>(idx + initial_vtx)); });
+                    PrimitiveJob& job = jobs.emplace_back();
+                    job.path = mesh_path;
+                    job.mesh_index = static_cast<uint32_t>(jobs.size() - 1);
+                    job.material_index = p.materialIndex.value();
+                    job.primitive = &p;
                 }
 
-                // load vertex positions
-                {
-                    fastgltf::Accessor& posAccessor = asset.accessors[p.findAttribute("POSITION")->accessorIndex];
-                    positions.resize(positions.size() + posAccessor.count);
-                    vertices.resize(vertices.size() + posAccessor.count);
-
-                    fastgltf::iterateAccessorWithIndex<glm::vec3>(asset,
-                                                                  posAccessor,
-                                                                  [&](glm::vec3 v, size_t index)
-                                                                  {
-                                                                      Vertex newvtx;
-                                                                      newvtx.normal = {1, 0, 0};
-                                                                      newvtx.color = glm::vec4{1.f};
-                                                                      newvtx.uv_x = 0;
-                                                                      newvtx.uv_y = 0;
-                                                                      positions[initial_vtx + index] = glm::vec4(v, 0.f);
-                                                                      vertices[initial_vtx + index] = newvtx;
-                                                                  });
-                }
+                node_mesh_records.push_back(static_cast<uint32_t>(it->second));
+            }
+        }
+        record.mesh_count = static_cast<uint32_t>(node_mesh_records.size()) - record.first_mesh;
 
-                // load vertex normals
-                auto* normals = p.findAttribute("NORMAL");
-                if (normals != p.attributes.end())
-                {
-                    fastgltf::iterateAccessorWithIndex<glm::vec3>(asset,
-                                                                  asset.accessors[normals->accessorIndex],
-                                                                  [&](glm::vec3 v, size_t index)
-                                                                  { vertices[initial_vtx + index].normal = v; });
-                }
+        for (const size_t child_index : asset_node.children) traverse_node(child_index, node_record);
+    };
 
-                // load UVs
-                auto* uv = p.findAttribute("TEXCOORD_0");
-                if (uv != p.attributes.end())
-                {
-                    fastgltf::iterateAccessorWithIndex<glm::vec2>(asset,
-                                                                  asset.accessors[uv->accessorIndex],
-                                                                  [&](glm::vec2 v, size_t index)
-                                                                  {
-                                                                      vertices[initial_vtx + index].uv_x = v.x;
-                                                                      vertices[initial_vtx + index].uv_y = v.y;
-                                                                  });
-                }
+    for (const size_t node_index : asset.scenes[0].nodeIndices) traverse_node(node_index, asset_file::NO_PARENT);
 
-                // load tangents or generate them
-                auto* tangents = p.findAttribute("TANGENT");
-                if (tangents != p.attributes.end())
-                {
-                    fastgltf::iterateAccessorWithIndex<glm::vec4>(asset,
-                                                                  asset.accessors[tangents->accessorIndex],
-                                                                  [&](glm::vec4 v, size_t index)
-                                                                  { vertices[initial_vtx + index].tangent = v; });
-                }
-                else
-                {
-                    struct Context
-                    {
-                        std::vector<uint32_t>* indices;
-                        std::vector<glm::vec4>* positions;
-                        std::vector<Vertex>* vertices;
-                    } userContext;
-                    userContext.indices = &indices;
-                    userContext.positions = &positions;
-                    userContext.vertices = &vertices;
-
-                    SMikkTSpaceInterface mikkTSpaceInterface;
-                    mikkTSpaceInterface.m_getNumFaces = [](SMikkTSpaceContext const* pContext) -> int
-                    {
-                        const auto* context = static_cast<Context*>(pContext->m_pUserData);
-                        return static_cast<int>(context->indices->size()) / 3;
-                    };
-                    mikkTSpaceInterface.m_getNumVerticesOfFace = [](SMikkTSpaceContext const*, int) -> int { return 3; };
-                    mikkTSpaceInterface.m_getPosition =
-                        [](SMikkTSpaceContext const* pContext, float* fvPosOut, int iFace, int iVert)
-                    {
-                        const auto* context = static_cast<Context*>(pContext->m_pUserData);
-                        const auto& vertexIndex = context->indices->at(static_cast<size_t>(iFace * 3 + iVert));
-                        const auto& position = context->positions->at(vertexIndex);
-
-                        fvPosOut[0] = position.x;
-                        fvPosOut[1] = position.y;
-                        fvPosOut[2] = position.z;
-                    };
-                    mikkTSpaceInterface.m_getNormal =
-                        [](SMikkTSpaceContext const* pContext, float* fvNormOut, int iFace, int iVert)
-                    {
-                        const auto* context = static_cast<Context*>(pContext->m_pUserData);
-                        const auto& vertexIndex = context->indices->at(static_cast<size_t>(iFace * 3 + iVert));
-                        const auto& vertex = context->vertices->at(vertexIndex);
-
-                        fvNormOut[0] = vertex.normal.x;
-                        fvNormOut[1] = vertex.normal.y;
-                        fvNormOut[2] = vertex.normal.z;
-                    };
-                    mikkTSpaceInterface.m_getTexCoord =
-                        [](SMikkTSpaceContext const* pContext, float* fvTexcOut, int iFace, int iVert)
-                    {
-                        const auto* context = static_cast<Context*>(pContext->m_pUserData);
-                        const auto vertexIndex = context->indices->at(static_cast<size_t>(iFace * 3 + iVert));
-                        const auto& vertex = context->vertices->at(vertexIndex);
-
-                        fvTexcOut[0] = vertex.uv_x;
-                        fvTexcOut[1] = vertex.uv_y;
-                    };
-                    mikkTSpaceInterface.m_setTSpaceBasic =
-                        [](SMikkTSpaceContext const* pContext, float const* fvTangent, float fSign, int iFace, int iVert)
-                    {
-                        auto* context = static_cast<Context*>(pContext->m_pUserData);
-                        const auto vertexIndex = context->indices->at(static_cast<size_t>(iFace * 3 + iVert));
-                        auto& vertex = context->vertices->at(vertexIndex);
-
-                        vertex.tangent.x = fvTangent[0];
-                        vertex.tangent.y = fvTangent[1];
-                        vertex.tangent.z = fvTangent[2];
-                        vertex.tangent.w = fSign;
-                    };
-                    mikkTSpaceInterface.m_setTSpace = nullptr;
-
-                    SMikkTSpaceContext mikkTSpaceContext;
-                    mikkTSpaceContext.m_pInterface = &mikkTSpaceInterface;
-                    mikkTSpaceContext.m_pUserData = &userContext;
-
-                    genTangSpaceDefault(&mikkTSpaceContext);
-                }
+    std::vector<TextureRequest> texture_requests;
+    {
+        using texture_compression::TextureUsage;
 
-                // load vertex colors
-                auto* colors = p.findAttribute("COLOR_0");
-                if (colors != p.attributes.end())
-                {
-                    fastgltf::iterateAccessorWithIndex<glm::vec4>(asset,
-                                                                  asset.accessors[colors->accessorIndex],
-                                                                  [&](glm::vec4 v, size_t index)
-                                                                  { vertices[initial_vtx + index].color = v; });
-                }
+        std::unordered_set<size_t> requested_materials;
+        std::unordered_set<std::string> requested_textures;
 
-                node.meshes.push_back(Engine::get().resources().load<Mesh>(path / "mesh" / name / std::to_string(prim_index),
-                                                                           mesh_index++,
-                                                                           indices,
-                                                                           positions,
-                                                                           vertices,
-                                                                           load_material(p.materialIndex.value())));
-            }
+        auto request_texture = [&](const fastgltf::TextureInfo& texture_info, TextureUsage usage)
+        {
+            if (requested_textures.insert(get_texture_path(path, texture_info.textureIndex, usage).string()).second)
+                texture_requests.push_back({texture_info.textureIndex, usage});
+        };
+
+        for (const PrimitiveJob& job : jobs)
+        {
+            if (!requested_materials.insert(job.material_index).second) continue;
+
+            const fastgltf::Material& material_asset = asset.materials[job.material_index];
+            if (material_asset.pbrData.baseColorTexture.has_value())
+                request_texture(material_asset.pbrData.baseColorTexture.value(), TextureUsage::Color);
+            if (material_asset.normalTexture.has_value())
+                request_texture(material_asset.normalTexture.value(), TextureUsage::Normal);
+            if (material_asset.pbrData.metallicRoughnessTexture.has_value())
+                request_texture(material_asset.pbrData.metallicRoughnessTexture.value(), TextureUsage::MetalRoughness);
+            if (material_asset.emissiveTexture.has_value())
+                request_texture(material_asset.emissiveTexture.value(), TextureUsage::Emissive);
         }
+    }
+
+    std::vector<asset_file::TextureRecord> texture_records;
+    std::vector<TextureLevel> level_records;
+    std::unordered_map<uint64_t, size_t> texture_record_lookup;
+    load_textures(path,
+                  asset,
+                  texture_requests,
+                  threads,
+                  compress,
+                  texture_decode_budget,
+                  [&](size_t request_index, const TextureData& data, uint64_t content_key)
+                  {
+                      const size_t texture_index = texture_requests[request_index].texture_index;
+                      const std::filesystem::path texture_path =
+                          get_texture_path(path, texture_index, texture_requests[request_index].usage);
+
+                      // Duplicates point at the pixels and levels already written for the first one.
+                      auto [it, inserted] = texture_record_lookup.try_emplace(content_key, texture_records.size());
+                      if (!inserted)
+                      {
+                          asset_file::TextureRecord record = texture_records[it->second];
+                          record.path = writer.add_string(texture_path.string());
+                          texture_records.push_back(record);
+                          return;
+                      }
+
+                      texture_records.push_back(
+                          write_texture_record(writer,
+                                               texture_path,
+                                               get_sampler_create_info(asset, asset.textures[texture_index]),
+                                               data,
+                                               content_key,
+                                               level_records));
+                  });
 
-        for (const size_t child_index : asset_node.children) traverse_node(child_index, node);
+    threads.parallel_for(jobs.size(),
+                         [&](size_t job_index)
+                         {
+                             PrimitiveJob& job = jobs[job_index];
+                             load_primitive(asset, *job.primitive, job.indices, job.positions, job.vertices);
+
+                             job.content_key = hash_span(std::span<const uint32_t>(job.indices));
+                             job.content_key = hash_span(std::span<const glm::vec3>(job.positions), job.content_key);
+                             job.content_key = hash_span(std::span<const ImportVertex>(job.vertices), job.content_key);
+                         });
+
+    // Repeated geometry within the model is only built and written once.
+    std::unordered_map<uint64_t, size_t> geometry_lookup;
+    for (size_t job_index = 0; job_index < jobs.size(); ++job_index)
+    {
+        PrimitiveJob& job = jobs[job_index];
+        job.source_job = job_index;
+        if constexpr (DEDUPLICATE_RESOURCES)
+            job.source_job = geometry_lookup.try_emplace(job.content_key, job_index).first->second;
+    }
+
+    threads.parallel_for(jobs.size(),
+                         [&](size_t job_index)
+                         {
+                             PrimitiveJob& job = jobs[job_index];
+                             if (job.source_job == job_index)
+                             {
+                                 job.data = Mesh::build(job.path,
+                                                        threads,
+                                                        std::move(job.indices),
+                                                        std::move(job.positions),
+                                                        std::move(job.vertices));
+                             }
+
+                             job.indices = {};
+                             job.positions = {};
+                             job.vertices = {};
+                         });
+
+    // Same resolution as load_asset's find_texture, missing textures fall back to dev/missing when the file is loaded.
+    using texture_compression::TextureUsage;
+    auto get_material_texture_path = [&](const auto& texture_info, TextureUsage usage, const char* fallback) -> std::string
+    {
+        if (!texture_info.has_value()) return fallback;
+        return get_texture_path(path, texture_info.value().textureIndex, usage).string();
     };
 
-    for (const size_t node_index : asset.scenes[0].nodeIndices) traverse_node(node_index, m_root);
-}
\ No newline at end of file
+    std::vector<asset_file::MaterialRecord> material_records;
+    std::unordered_map<size_t, uint32_t> material_lookup;
+    std::vector<asset_file::MeshRecord> mesh_records;
+    mesh_records.reserve(jobs.size());
+    for (PrimitiveJob& job : jobs)
+    {
+        auto [it, inserted] = material_lookup.try_emplace(job.material_index, static_cast<uint32_t>(material_records.size()));
+        if (inserted)
+        {
+            const fastgltf::Material& material_asset = asset.materials[job.material_index];
+
+            asset_file::MaterialRecord& record = material_records.emplace_back();
+            record.path = writer.add_string((path / "material" / std::to_string(job.material_index)).string());
+            record.albedo = writer.add_string(
+                get_material_texture_path(material_asset.pbrData.baseColorTexture, TextureUsage::Color, "dev/white"));
+            record.normal = writer.add_string(
+                get_material_texture_path(material_asset.normalTexture, TextureUsage::Normal, "dev/normal"));
+            record.metal_roughness = writer.add_string(get_material_texture_path(
+                material_asset.pbrData.metallicRoughnessTexture, TextureUsage::MetalRoughness, "dev/black"));
+            record.emissive = writer.add_string(
+                get_material_texture_path(material_asset.emissiveTexture, TextureUsage::Emissive, "dev/black"));
+        }
+
+        const size_t job_index = mesh_records.size();
+        if (job.source_job != job_index)
+        {
+            // Repeated geometry reuses the sections of its source, only the path and material differ.
+            asset_file::MeshRecord record = mesh_records[job.source_job];
+            record.path = writer.add_string(job.path.string());
+            record.mesh_index = job.mesh_index;
+            record.material = it->second;
+            mesh_records.push_back(record);
+            continue;
+        }
+
+        mesh_records.push_back(
+            write_mesh_record(writer, job.path, job.mesh_index, it->second, job.content_key, job.data.view()));
+
+        // Written out, later jobs only need the record.
+        job.data = {};
+    }
+
+    return writer.finish(node_records,
+                         node_mesh_records,
+                         node_instance_records,
+                         mesh_records,
+                         material_records,
+                         texture_records,
+                         level_records);
+}
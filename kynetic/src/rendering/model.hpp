@@ -9,6 +9,13 @@ namespace kynetic
 class Model : public Resource
 {
 public:
+    struct Instance
+    {
+        glm::vec3 translation{0.0f, 0.0f, 0.0f};
+        glm::quat rotation{1.0f, 0.0f, 0.0f, 0.0f};
+        glm::vec3 scale{1.0f, 1.0f, 1.0f};
+    };
+
     struct Node
     {
         glm::vec3 translation{0.0f, 0.0f, 0.0f};
@@ -19,13 +26,32 @@ public:
         std::vector<Node> children;
 
         std::vector<std::shared_ptr<class Mesh>> meshes;
+
+        // EXT_mesh_gpu_instancing transforms relative to the node, the meshes are placed once per instance when set.
+        std::vector<Instance> instances;
     };
 
 private:
     Node m_root{};
 
+    // Loads the baked .kasset for key if there is a valid one, returns false if the glTF has to be imported instead. Given
+    // memory, loads the asset bake put in there instead of the cached file.
+    bool load_asset(const std::filesystem::path& path, uint64_t key, std::vector<uint8_t>&& memory = {});
+
 public:
-    Model(const std::filesystem::path& path);
+    // Upper bound on decoded texture memory held at once while importing.
+    static constexpr size_t DEFAULT_TEXTURE_DECODE_BUDGET = 512ull * 1024 * 1024;
+
+    Model(const std::filesystem::path& path, size_t texture_decode_budget = DEFAULT_TEXTURE_DECODE_BUDGET);
+
+    // Imports the glTF at path and writes it to the asset file the constructor loads, without touching the device. The
+    // key covers compress, so it has to match what the target device supports. Returns false if nothing was written.
+    // Given memory, the asset file is baked into it instead of the cache.
+    static bool bake(const std::filesystem::path& path,
+                     class ThreadPool& threads,
+                     bool compress,
+                     size_t texture_decode_budget = DEFAULT_TEXTURE_DECODE_BUDGET,
+                     std::vector<uint8_t>* memory = nullptr);
 
     [[nodiscard]] const Node& get_root_node() { return m_root; }
 };
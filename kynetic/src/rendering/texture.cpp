@@ -3,6 +3,7 @@
 //
 
 #include "descriptor.hpp"
+#include "upload_batch.hpp"
 
 #include "core/device.hpp"
 #include "core/engine.hpp"
@@ -30,11 +31,45 @@ Texture::Texture(const std::filesystem::path& path,
                  VkExtent3D extent,
                  VkFormat format,
                  VkImageUsageFlags usage_flags,
-                 const VkSamplerCreateInfo& sampler_create_info)
+                 const VkSamplerCreateInfo& sampler_create_info,
+                 bool mipmapped)
     : Resource(Type::Texture, path.string())
 {
     Device& device = Engine::get().device();
-    m_image = device.create_image(data, extent, format, usage_flags);
+    m_image = device.create_image(data, extent, format, usage_flags, mipmapped);
+
+    init(sampler_create_info);
+}
+
+Texture::Texture(const std::filesystem::path& path,
+                 const TextureDataView& data,
+                 VkImageUsageFlags usage_flags,
+                 const VkSamplerCreateInfo& sampler_create_info,
+                 UploadBatch& uploads)
+    : Resource(Type::Texture, path.string())
+{
+    Device& device = Engine::get().device();
+    m_image = device.create_image(data.extent,
+                                  data.format,
+                                  usage_flags | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                                  static_cast<uint32_t>(data.levels.size()),
+                                  data.swizzle);
+
+    std::vector<VkBufferImageCopy> regions(data.levels.size());
+    for (uint32_t level = 0; level < regions.size(); ++level)
+    {
+        VkBufferImageCopy& region = regions[level];
+        region.bufferOffset = data.levels[level].offset;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent.width = std::max(data.extent.width >> level, 1u);
+        region.imageExtent.height = std::max(data.extent.height >> level, 1u);
+        region.imageExtent.depth = 1;
+    }
+
+    uploads.upload(m_image, data.pixels.data(), data.pixels.size(), regions);
 
     init(sampler_create_info);
 }
@@ -8,6 +8,39 @@
 namespace kynetic
 {
 
+struct TextureLevel
+{
+    size_t offset;
+    size_t size;
+};
+
+// Non-owning view of a texture's contents, backed either by TextureData or by a mapped asset file.
+struct TextureDataView
+{
+    VkFormat format{VK_FORMAT_R8G8B8A8_UNORM};
+    VkComponentMapping swizzle{};
+    VkExtent3D extent{};
+
+    std::span<const TextureLevel> levels;
+    std::span<const uint8_t> pixels;
+};
+
+// CPU side texture contents, as produced by the import pipeline and stored in the texture cache.
+struct TextureData
+{
+    using Level = TextureLevel;
+
+    VkFormat format{VK_FORMAT_R8G8B8A8_UNORM};
+    VkComponentMapping swizzle{};
+    VkExtent3D extent{};
+
+    // Level i is extent >> i, clamped to 1, stored back to back in pixels.
+    std::vector<Level> levels;
+    std::vector<uint8_t> pixels;
+
+    [[nodiscard]] TextureDataView view() const { return {format, swizzle, extent, levels, pixels}; }
+};
+
 class Texture : public Resource
 {
     friend class ResourceManager;
@@ -27,7 +60,14 @@ public:
             VkExtent3D extent,
             VkFormat format,
             VkImageUsageFlags usage_flags,
-            const VkSamplerCreateInfo& sampler_create_info);
+            const VkSamplerCreateInfo& sampler_create_info,
+            bool mipmapped = false);
+    // Queues the pixel upload on uploads instead of submitting it right away, data has to outlive the next flush.
+    Texture(const std::filesystem::path& path,
+            const TextureDataView& data,
+            VkImageUsageFlags usage_flags,
+            const VkSamplerCreateInfo& sampler_create_info,
+            class UploadBatch& uploads);
     ~Texture() override;
 };
 
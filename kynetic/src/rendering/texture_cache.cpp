@@ -0,0 +1,116 @@
+//
+// Created by kenny on 12/4/25.
+//
+
+#include "texture_cache.hpp"
+
+#include <fstream>
+
+using namespace kynetic;
+
+constexpr uint32_t TEXTURE_CACHE_MAGIC = 0x5845544b;  // "KTEX"
+
+struct TextureCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+
+    VkFormat format;
+    VkComponentMapping swizzle;
+    VkExtent3D extent;
+
+    uint32_t level_count;
+    uint64_t pixel_size;
+};
+
+std::filesystem::path texture_cache::get_path(uint64_t key)
+{
+    return std::filesystem::path(CACHE_DIRECTORY) / "texture" / fmt::format("{:016x}.ktex", key);
+}
+
+bool texture_cache::load(uint64_t key, TextureData& data)
+{
+    std::ifstream file(get_path(key), std::ios::binary);
+    if (!file) return false;
+
+    TextureCacheHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || header.magic != TEXTURE_CACHE_MAGIC || header.version != VERSION || header.key != key) return false;
+
+    const uint64_t expected_size =
+        sizeof(TextureCacheHeader) + header.level_count * sizeof(TextureData::Level) + header.pixel_size;
+
+    std::error_code error;
+    if (std::filesystem::file_size(get_path(key), error) != expected_size || error)
+    {
+        fmt::print(stderr, "Texture cache entry '{}' is corrupt, rebuilding\n", get_path(key).string());
+        return false;
+    }
+
+    data.levels.resize(header.level_count);
+    data.pixels.resize(header.pixel_size);
+    file.read(reinterpret_cast<char*>(data.levels.data()),
+              static_cast<std::streamsize>(data.levels.size() * sizeof(TextureData::Level)));
+    file.read(reinterpret_cast<char*>(data.pixels.data()), static_cast<std::streamsize>(data.pixels.size()));
+    if (!file.good())
+    {
+        fmt::print(stderr, "Texture cache entry '{}' could not be read, rebuilding\n", get_path(key).string());
+        return false;
+    }
+
+    data.format = header.format;
+    data.swizzle = header.swizzle;
+    data.extent = header.extent;
+
+    return true;
+}
+
+void texture_cache::store(uint64_t key, const TextureData& data)
+{
+    const std::filesystem::path path = get_path(key);
+
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+    if (error)
+    {
+        fmt::print(stderr, "Failed to create texture cache directory '{}': {}\n", path.parent_path().string(), error.message());
+        return;
+    }
+
+    TextureCacheHeader header{};
+    header.magic = TEXTURE_CACHE_MAGIC;
+    header.version = VERSION;
+    header.key = key;
+    header.format = data.format;
+    header.swizzle = data.swizzle;
+    header.extent = data.extent;
+    header.level_count = static_cast<uint32_t>(data.levels.size());
+    header.pixel_size = data.pixels.size();
+
+    // Write to a temporary file first so a crash mid-write never leaves a valid looking entry behind.
+    std::filesystem::path temp_path = path;
+    temp_path += fmt::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+    bool written;
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(data.levels.data()),
+                   static_cast<std::streamsize>(data.levels.size() * sizeof(TextureData::Level)));
+        file.write(reinterpret_cast<const char*>(data.pixels.data()), static_cast<std::streamsize>(data.pixels.size()));
+
+        written = file.good();
+    }
+
+    if (!written)
+    {
+        fmt::print(stderr, "Failed to write texture cache entry '{}'\n", path.string());
+        std::filesystem::remove(temp_path, error);
+        return;
+    }
+
+    std::filesystem::rename(temp_path, path, error);
+    if (error) std::filesystem::remove(temp_path, error);
+}
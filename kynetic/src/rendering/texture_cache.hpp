@@ -0,0 +1,25 @@
+//
+// Created by kenny on 12/4/25.
+//
+
+#pragma once
+
+#include "texture.hpp"
+
+namespace kynetic
+{
+
+namespace texture_cache
+{
+
+// Bump whenever the encoders or the file layout change, old entries are then ignored.
+constexpr uint32_t VERSION = 2;
+
+std::filesystem::path get_path(uint64_t key);
+
+bool load(uint64_t key, TextureData& data);
+void store(uint64_t key, const TextureData& data);
+
+}  // namespace texture_cache
+
+}  // namespace kynetic
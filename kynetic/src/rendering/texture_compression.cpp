@@ -0,0 +1,604 @@
+//
+// Created by kenny on 12/4/25.
+//
+
+#include "texture_compression.hpp"
+
+using namespace kynetic;
+
+// Straightforward single-pass encoders: principal axis endpoints, nearest index selection and one least squares refinement.
+// BC7 only uses mode 6 (one subset, RGBA endpoints with p-bits, 4-bit indices), which handles typical albedo well.
+
+constexpr uint32_t BLOCK_TEXELS = 16;
+
+struct Block
+{
+    float texels[BLOCK_TEXELS][4];
+};
+
+static Block load_block(const uint8_t* rgba,
+                        uint32_t width,
+                        uint32_t height,
+                        uint32_t block_x,
+                        uint32_t block_y,
+                        const uint8_t source_channels[4],
+                        uint32_t channel_count)
+{
+    Block block{};
+    for (uint32_t y = 0; y < 4; ++y)
+    {
+        // Edge blocks replicate the last row and column.
+        const uint32_t py = std::min(block_y * 4 + y, height - 1);
+        for (uint32_t x = 0; x < 4; ++x)
+        {
+            const uint32_t px = std::min(block_x * 4 + x, width - 1);
+            const uint8_t* texel = rgba + (static_cast<size_t>(py) * width + px) * 4;
+
+            for (uint32_t c = 0; c < channel_count; ++c) block.texels[y * 4 + x][c] = texel[source_channels[c]];
+        }
+    }
+    return block;
+}
+
+// Principal axis of the block through power iteration, good enough for picking endpoints.
+static void principal_axis(const Block& block, uint32_t channel_count, float mean[4], float axis[4])
+{
+    for (uint32_t c = 0; c < 4; ++c) mean[c] = 0.f;
+    for (const auto& texel : block.texels)
+        for (uint32_t c = 0; c < channel_count; ++c) mean[c] += texel[c] / BLOCK_TEXELS;
+
+    float covariance[4][4]{};
+    for (const auto& texel : block.texels)
+        for (uint32_t i = 0; i < channel_count; ++i)
+            for (uint32_t j = 0; j < channel_count; ++j)
+                covariance[i][j] += (texel[i] - mean[i]) * (texel[j] - mean[j]);
+
+    for (uint32_t c = 0; c < 4; ++c) axis[c] = c < channel_count ? 1.f : 0.f;
+
+    for (int iteration = 0; iteration < 8; ++iteration)
+    {
+        float next[4]{};
+        for (uint32_t i = 0; i < channel_count; ++i)
+            for (uint32_t j = 0; j < channel_count; ++j) next[i] += covariance[i][j] * axis[j];
+
+        float length = 0.f;
+        for (uint32_t c = 0; c < channel_count; ++c) length = std::max(length, std::abs(next[c]));
+        if (length < 1e-6f) break;
+
+        for (uint32_t c = 0; c < channel_count; ++c) axis[c] = next[c] / length;
+    }
+
+    float length = 0.f;
+    for (uint32_t c = 0; c < channel_count; ++c) length += axis[c] * axis[c];
+    length = std::sqrt(length);
+    for (uint32_t c = 0; c < channel_count; ++c) axis[c] = length > 0.f ? axis[c] / length : 0.f;
+}
+
+static void axis_endpoints(const Block& block, uint32_t channel_count, float e0[4], float e1[4])
+{
+    float mean[4], axis[4];
+    principal_axis(block, channel_count, mean, axis);
+
+    float t_min = FLT_MAX, t_max = -FLT_MAX;
+    for (const auto& texel : block.texels)
+    {
+        float t = 0.f;
+        for (uint32_t c = 0; c < channel_count; ++c) t += (texel[c] - mean[c]) * axis[c];
+        t_min = std::min(t_min, t);
+        t_max = std::max(t_max, t);
+    }
+
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        e0[c] = std::clamp(mean[c] + axis[c] * t_min, 0.f, 255.f);
+        e1[c] = std::clamp(mean[c] + axis[c] * t_max, 0.f, 255.f);
+    }
+}
+
+// Least squares endpoints for fixed interpolation weights, where weights[i] is the fraction of e1 used by texel i.
+static bool refine_endpoints(const Block& block,
+                             uint32_t channel_count,
+                             const float weights[BLOCK_TEXELS],
+                             float e0[4],
+                             float e1[4])
+{
+    float aa = 0.f, ab = 0.f, bb = 0.f;
+    float ax[4]{}, bx[4]{};
+    for (uint32_t i = 0; i < BLOCK_TEXELS; ++i)
+    {
+        const float b = weights[i];
+        const float a = 1.f - b;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (uint32_t c = 0; c < channel_count; ++c)
+        {
+            ax[c] += a * block.texels[i][c];
+            bx[c] += b * block.texels[i][c];
+        }
+    }
+
+    const float determinant = aa * bb - ab * ab;
+    if (std::abs(determinant) < 1e-6f) return false;
+
+    for (uint32_t c = 0; c < channel_count; ++c)
+    {
+        e0[c] = std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.f, 255.f);
+        e1[c] = std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.f, 255.f);
+    }
+    return true;
+}
+
+static void write_bits(uint8_t* out, uint32_t& bit, uint32_t value, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i, ++bit)
+        if (value & (1u << i)) out[bit / 8] |= static_cast<uint8_t>(1u << (bit % 8));
+}
+
+//
+// BC1
+//
+
+static uint16_t quantize_565(const float color[4])
+{
+    const auto r = static_cast<uint16_t>(std::lround(color[0] * 31.f / 255.f));
+    const auto g = static_cast<uint16_t>(std::lround(color[1] * 63.f / 255.f));
+    const auto b = static_cast<uint16_t>(std::lround(color[2] * 31.f / 255.f));
+    return static_cast<uint16_t>(r << 11 | g << 5 | b);
+}
+
+static void expand_565(uint16_t color, float out[3])
+{
+    const uint32_t r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+    out[0] = static_cast<float>(r << 3 | r >> 2);
+    out[1] = static_cast<float>(g << 2 | g >> 4);
+    out[2] = static_cast<float>(b << 3 | b >> 2);
+}
+
+static float fit_bc1(const Block& block, uint16_t c0, uint16_t c1, uint32_t& indices)
+{
+    float palette[4][3];
+    expand_565(c0, palette[0]);
+    expand_565(c1, palette[1]);
+    for (uint32_t c = 0; c < 3; ++c)
+    {
+        palette[2][c] = (2.f * palette[0][c] + palette[1][c]) / 3.f;
+        palette[3][c] = (palette[0][c] + 2.f * palette[1][c]) / 3.f;
+    }
+
+    float total_error = 0.f;
+    indices = 0;
+    for (uint32_t i = 0; i < BLOCK_TEXELS; ++i)
+    {
+        float best_error = FLT_MAX;
+        uint32_t best_index = 0;
+        for (uint32_t p = 0; p < 4; ++p)
+        {
+            float error = 0.f;
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                const float delta = block.texels[i][c] - palette[p][c];
+                error += delta * delta;
+            }
+            if (error < best_error)
+            {
+                best_error = error;
+                best_index = p;
+            }
+        }
+        indices |= best_index << (i * 2);
+        total_error += best_error;
+    }
+    return total_error;
+}
+
+static void encode_bc1_block(const Block& block, uint8_t* out)
+{
+    constexpr float INDEX_WEIGHTS[4] = {0.f, 1.f, 1.f / 3.f, 2.f / 3.f};
+
+    float e0[4], e1[4];
+    axis_endpoints(block, 3, e0, e1);
+
+    uint16_t c0 = quantize_565(e1), c1 = quantize_565(e0);
+    uint32_t indices;
+    float error = fit_bc1(block, c0, c1, indices);
+
+    float weights[BLOCK_TEXELS];
+    for (uint32_t i = 0; i < BLOCK_TEXELS; ++i) weights[i] = INDEX_WEIGHTS[(indices >> (i * 2)) & 3];
+
+    if (refine_endpoints(block, 3, weights, e0, e1))
+    {
+        const uint16_t refined_c0 = quantize_565(e0), refined_c1 = quantize_565(e1);
+        uint32_t refined_indices;
+        const float refined_error = fit_bc1(block, refined_c0, refined_c1, refined_indices);
+        if (refined_error < error)
+        {
+            c0 = refined_c0;
+            c1 = refined_c1;
+            indices = refined_indices;
+        }
+    }
+
+    // c0 > c1 selects the four color mode, swapping endpoints swaps indices 0 <-> 1 and 2 <-> 3.
+    if (c0 < c1)
+    {
+        std::swap(c0, c1);
+        indices ^= 0x55555555u;
+    }
+    else if (c0 == c1)
+    {
+        indices = 0;
+    }
+
+    out[0] = static_cast<uint8_t>(c0);
+    out[1] = static_cast<uint8_t>(c0 >> 8);
+    out[2] = static_cast<uint8_t>(c1);
+    out[3] = static_cast<uint8_t>(c1 >> 8);
+    memcpy(out + 4, &indices, sizeof(indices));
+}
+
+//
+// BC4 / BC5
+//
+
+static void encode_bc4_block(const Block& block, uint32_t channel, uint8_t* out)
+{
+    float min_value = 255.f, max_value = 0.f;
+    for (const auto& texel : block.texels)
+    {
+        min_value = std::min(min_value, texel[channel]);
+        max_value = std::max(max_value, texel[channel]);
+    }
+
+    const auto r0 = static_cast<uint8_t>(std::lround(max_value));
+    const auto r1 = static_cast<uint8_t>(std::lround(min_value));
+
+    memset(out, 0, 8);
+    out[0] = r0;
+    out[1] = r1;
+    if (r0 == r1) return;
+
+    // r0 > r1 selects the eight value mode, indices 2..7 interpolate from r0 towards r1.
+    float palette[8];
+    palette[0] = r0;
+    palette[1] = r1;
+    for (uint32_t i = 1; i < 7; ++i) palette[i + 1] = (static_cast<float>(7 - i) * r0 + static_cast<float>(i) * r1) / 7.f;
+
+    uint64_t indices = 0;
+    for (uint32_t i = 0; i < BLOCK_TEXELS; ++i)
+    {
+        float best_error = FLT_MAX;
+        uint64_t best_index = 0;
+        for (uint32_t p = 0; p < 8; ++p)
+        {
+            const float error = std::abs(block.texels[i][channel] - palette[p]);
+            if (error < best_error)
+            {
+                best_error = error;
+                best_index = p;
+            }
+        }
+        indices |= best_index << (i * 3);
+    }
+
+    for (uint32_t i = 0; i < 6; ++i) out[2 + i] = static_cast<uint8_t>(indices >> (i * 8));
+}
+
+//
+// BC7 mode 6
+//
+
+constexpr int BC7_WEIGHTS_4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+struct Bc7Endpoint
+{
+    uint8_t value[4];  // 7 bit
+    uint8_t pbit;
+};
+
+static Bc7Endpoint quantize_bc7(const float color[4])
+{
+    Bc7Endpoint best{};
+    float best_error = FLT_MAX;
+    for (uint8_t p = 0; p < 2; ++p)
+    {
+        Bc7Endpoint candidate{};
+        candidate.pbit = p;
+
+        float error = 0.f;
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            const long q = std::clamp(std::lround((color[c] - p) / 2.f), 0l, 127l);
+            candidate.value[c] = static_cast<uint8_t>(q);
+
+            const float reconstructed = static_cast<float>(q << 1 | p);
+            error += (reconstructed - color[c]) * (reconstructed - color[c]);
+        }
+
+        if (error < best_error)
+        {
+            best_error = error;
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+static float fit_bc7(const Block& block, const Bc7Endpoint& a, const Bc7Endpoint& b, uint8_t indices[BLOCK_TEXELS])
+{
+    int e0[4], e1[4];
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        e0[c] = a.value[c] << 1 | a.pbit;
+        e1[c] = b.value[c] << 1 | b.pbit;
+    }
+
+    float palette[16][4];
+    for (uint32_t i = 0; i < 16; ++i)
+        for (uint32_t c = 0; c < 4; ++c)
+            palette[i][c] = static_cast<float>(((64 - BC7_WEIGHTS_4[i]) * e0[c] + BC7_WEIGHTS_4[i] * e1[c] + 32) >> 6);
+
+    float direction[4], length_sq = 0.f;
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        direction[c] = static_cast<float>(e1[c] - e0[c]);
+        length_sq += direction[c] * direction[c];
+    }
+
+    float total_error = 0.f;
+    for (uint32_t i = 0; i < BLOCK_TEXELS; ++i)
+    {
+        // Project onto the endpoint line for a first guess, then check its neighbours.
+        float t = 0.f;
+        if (length_sq > 0.f)
+        {
+            for (uint32_t c = 0; c < 4; ++c) t += (block.texels[i][c] - static_cast<float>(e0[c])) * direction[c];
+            t = std::clamp(t / length_sq, 0.f, 1.f);
+        }
+        const int guess = static_cast<int>(std::lround(t * 15.f));
+
+        float best_error = FLT_MAX;
+        uint8_t best_index = 0;
+        for (int candidate = std::max(guess - 1, 0); candidate <= std::min(guess + 1, 15); ++candidate)
+        {
+            float error = 0.f;
+            for (uint32_t c = 0; c < 4; ++c)
+                error += (block.texels[i][c] - palette[candidate][c]) * (block.texels[i][c] - palette[candidate][c]);
+            if (error < best_error)
+            {
+                best_error = error;
+                best_index = static_cast<uint8_t>(candidate);
+            }
+        }
+
+        indices[i] = best_index;
+        total_error += best_error;
+    }
+    return total_error;
+}
+
+static void encode_bc7_block(const Block& block, uint8_t* out)
+{
+    float e0[4], e1[4];
+    axis_endpoints(block, 4, e0, e1);
+
+    Bc7Endpoint a = quantize_bc7(e0), b = quantize_bc7(e1);
+    uint8_t indices[BLOCK_TEXELS];
+    float error = fit_bc7(block, a, b, indices);
+
+    float weights[BLOCK_TEXELS];
+    for (uint32_t i = 0; i < BLOCK_TEXELS; ++i) weights[i] = static_cast<float>(BC7_WEIGHTS_4[indices[i]]) / 64.f;
+
+    if (refine_endpoints(block, 4, weights, e0, e1))
+    {
+        const Bc7Endpoint refined_a = quantize_bc7(e0), refined_b = quantize_bc7(e1);
+        uint8_t refined_indices[BLOCK_TEXELS];
+        const float refined_error = fit_bc7(block, refined_a, refined_b, refined_indices);
+        if (refined_error < error)
+        {
+            a = refined_a;
+            b = refined_b;
+            memcpy(indices, refined_indices, sizeof(indices));
+        }
+    }
+
+    // The anchor index drops its top bit, so it must be < 8.
+    if (indices[0] & 8)
+    {
+        std::swap(a, b);
+        for (uint8_t& index : indices) index = static_cast<uint8_t>(15 - index);
+    }
+
+    memset(out, 0, 16);
+    uint32_t bit = 0;
+    write_bits(out, bit, 1u << 6, 7);
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        write_bits(out, bit, a.value[c], 7);
+        write_bits(out, bit, b.value[c], 7);
+    }
+    write_bits(out, bit, a.pbit, 1);
+    write_bits(out, bit, b.pbit, 1);
+    write_bits(out, bit, indices[0], 3);
+    for (uint32_t i = 1; i < BLOCK_TEXELS; ++i) write_bits(out, bit, indices[i], 4);
+}
+
+texture_compression::FormatChoice texture_compression::choose_format(TextureUsage usage,
+                                                                     const uint8_t* rgba,
+                                                                     uint32_t width,
+                                                                     uint32_t height)
+{
+    constexpr VkComponentMapping IDENTITY{};
+    constexpr VkComponentMapping GRAYSCALE{VK_COMPONENT_SWIZZLE_R,
+                                           VK_COMPONENT_SWIZZLE_R,
+                                           VK_COMPONENT_SWIZZLE_R,
+                                           VK_COMPONENT_SWIZZLE_ONE};
+
+    bool grayscale = true;
+    bool opaque = true;
+    const size_t texel_count = static_cast<size_t>(width) * height;
+    for (size_t i = 0; i < texel_count && (grayscale || opaque); ++i)
+    {
+        const uint8_t* texel = rgba + i * 4;
+        grayscale = grayscale && texel[0] == texel[1] && texel[1] == texel[2];
+        opaque = opaque && texel[3] == 255;
+    }
+
+    switch (usage)
+    {
+        case TextureUsage::Normal:
+            return {VK_FORMAT_BC5_UNORM_BLOCK, IDENTITY, {0, 1, 2, 3}};
+        case TextureUsage::MetalRoughness:
+            // Green and blue are stored in BC5's two channels, red (occlusion in ORM maps) is dropped, see TextureUsage.
+            return {VK_FORMAT_BC5_UNORM_BLOCK,
+                    {VK_COMPONENT_SWIZZLE_ONE, VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_ONE},
+                    {1, 2, 0, 3}};
+        case TextureUsage::Emissive:
+            if (grayscale) return {VK_FORMAT_BC4_UNORM_BLOCK, GRAYSCALE, {0, 1, 2, 3}};
+            return {VK_FORMAT_BC1_RGB_UNORM_BLOCK, IDENTITY, {0, 1, 2, 3}};
+        case TextureUsage::Color:
+        default:
+            if (grayscale && opaque) return {VK_FORMAT_BC4_UNORM_BLOCK, GRAYSCALE, {0, 1, 2, 3}};
+            return {VK_FORMAT_BC7_UNORM_BLOCK, IDENTITY, {0, 1, 2, 3}};
+    }
+}
+
+bool texture_compression::is_block_compressed(VkFormat format)
+{
+    switch (format)
+    {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+            return true;
+        default:
+            return false;
+    }
+}
+
+size_t texture_compression::get_level_size(VkFormat format, uint32_t width, uint32_t height)
+{
+    const size_t blocks = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4);
+
+    switch (format)
+    {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+            return blocks * 8;
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+            return blocks * 16;
+        default:
+            return static_cast<size_t>(width) * height * 4;
+    }
+}
+
+uint32_t texture_compression::get_level_count(uint32_t width, uint32_t height)
+{
+    return static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+}
+
+void texture_compression::downsample(TextureUsage usage,
+                                     const uint8_t* rgba,
+                                     uint32_t width,
+                                     uint32_t height,
+                                     std::vector<uint8_t>& out)
+{
+    const uint32_t out_width = std::max(width >> 1, 1u);
+    const uint32_t out_height = std::max(height >> 1, 1u);
+    out.resize(static_cast<size_t>(out_width) * out_height * 4);
+
+    for (uint32_t y = 0; y < out_height; ++y)
+    {
+        // Odd sizes fold the leftover row and column into the last texel instead of dropping them.
+        const uint32_t y0 = y * height / out_height;
+        const uint32_t y1 = std::max((y + 1) * height / out_height, y0 + 1);
+
+        for (uint32_t x = 0; x < out_width; ++x)
+        {
+            const uint32_t x0 = x * width / out_width;
+            const uint32_t x1 = std::max((x + 1) * width / out_width, x0 + 1);
+
+            float sum[4]{};
+            for (uint32_t sy = y0; sy < y1; ++sy)
+                for (uint32_t sx = x0; sx < x1; ++sx)
+                    for (uint32_t c = 0; c < 4; ++c) sum[c] += rgba[(static_cast<size_t>(sy) * width + sx) * 4 + c];
+
+            const float scale = 1.f / static_cast<float>((x1 - x0) * (y1 - y0));
+            for (float& value : sum) value *= scale;
+
+            if (usage == TextureUsage::Normal)
+            {
+                glm::vec3 normal = glm::vec3(sum[0], sum[1], sum[2]) / 127.5f - 1.f;
+                const float length = glm::length(normal);
+                normal = length > 0.f ? normal / length : glm::vec3(0.f, 0.f, 1.f);
+                for (uint32_t c = 0; c < 3; ++c) sum[c] = (normal[c] + 1.f) * 127.5f;
+            }
+
+            uint8_t* texel = out.data() + (static_cast<size_t>(y) * out_width + x) * 4;
+            for (uint32_t c = 0; c < 4; ++c) texel[c] = static_cast<uint8_t>(std::clamp(sum[c] + 0.5f, 0.f, 255.f));
+        }
+    }
+}
+
+void texture_compression::encode(const FormatChoice& choice,
+                                 const uint8_t* rgba,
+                                 uint32_t width,
+                                 uint32_t height,
+                                 uint8_t* out,
+                                 uint32_t first_block_row,
+                                 uint32_t block_row_count)
+{
+    const VkFormat format = choice.format;
+    const uint8_t* channels = choice.source_channels;
+
+    const uint32_t blocks_x = (width + 3) / 4;
+    const uint32_t blocks_y = (height + 3) / 4;
+    const uint32_t last_block_row = std::min(first_block_row + block_row_count, blocks_y);
+
+    if (!is_block_compressed(format))
+    {
+        const uint32_t first_row = first_block_row * 4, last_row = std::min(last_block_row * 4, height);
+        if (first_row < last_row)
+            memcpy(out + static_cast<size_t>(first_row) * width * 4,
+                   rgba + static_cast<size_t>(first_row) * width * 4,
+                   static_cast<size_t>(last_row - first_row) * width * 4);
+        return;
+    }
+
+    const size_t block_size = get_level_size(format, 4, 4);
+
+    for (uint32_t by = first_block_row; by < last_block_row; ++by)
+    {
+        for (uint32_t bx = 0; bx < blocks_x; ++bx)
+        {
+            uint8_t* block_out = out + (static_cast<size_t>(by) * blocks_x + bx) * block_size;
+
+            switch (format)
+            {
+                case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+                case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+                    encode_bc1_block(load_block(rgba, width, height, bx, by, channels, 3), block_out);
+                    break;
+                case VK_FORMAT_BC4_UNORM_BLOCK:
+                    encode_bc4_block(load_block(rgba, width, height, bx, by, channels, 1), 0, block_out);
+                    break;
+                case VK_FORMAT_BC5_UNORM_BLOCK:
+                {
+                    const Block block = load_block(rgba, width, height, bx, by, channels, 2);
+                    encode_bc4_block(block, 0, block_out);
+                    encode_bc4_block(block, 1, block_out + 8);
+                    break;
+                }
+                case VK_FORMAT_BC7_UNORM_BLOCK:
+                    encode_bc7_block(load_block(rgba, width, height, bx, by, channels, 4), block_out);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
@@ -0,0 +1,60 @@
+//
+// Created by kenny on 12/4/25.
+//
+
+#pragma once
+
+namespace kynetic
+{
+
+namespace texture_compression
+{
+
+// What a texture is sampled as, decides which block format it is encoded to.
+enum class TextureUsage
+{
+    Color,
+    Normal,
+    // glTF metallic in blue and roughness in green. Only those two are kept, red is dropped even in ORM maps that store
+    // occlusion there, since materials don't sample occlusion.
+    MetalRoughness,
+    Emissive
+};
+
+struct FormatChoice
+{
+    VkFormat format{VK_FORMAT_R8G8B8A8_UNORM};
+    // Block formats with fewer channels are swizzled back to the layout shaders expect.
+    VkComponentMapping swizzle{};
+    // Source channel feeding each encoded channel.
+    uint8_t source_channels[4]{0, 1, 2, 3};
+};
+
+// Picks a block format for the given RGBA8 pixels:
+// - Color: BC7, or BC4 if the image is grayscale and opaque
+// - Normal: BC5 holding xy, z has to be reconstructed when sampling
+// - MetalRoughness: BC5 holding roughness (g) and metallic (b), swizzled back into place
+// - Emissive: BC1, or BC4 if the image is grayscale
+FormatChoice choose_format(TextureUsage usage, const uint8_t* rgba, uint32_t width, uint32_t height);
+
+[[nodiscard]] bool is_block_compressed(VkFormat format);
+[[nodiscard]] size_t get_level_size(VkFormat format, uint32_t width, uint32_t height);
+[[nodiscard]] uint32_t get_level_count(uint32_t width, uint32_t height);
+
+// Box filters an RGBA8 level down to the next one, max(width >> 1, 1) by max(height >> 1, 1). Normal maps are
+// renormalized so distant mips keep unit length normals.
+void downsample(TextureUsage usage, const uint8_t* rgba, uint32_t width, uint32_t height, std::vector<uint8_t>& out);
+
+// Encodes block rows [first_block_row, first_block_row + block_row_count) of an RGBA8 image into out, which holds the whole
+// level. Rows are independent, so they can be encoded from several threads at once.
+void encode(const FormatChoice& choice,
+            const uint8_t* rgba,
+            uint32_t width,
+            uint32_t height,
+            uint8_t* out,
+            uint32_t first_block_row,
+            uint32_t block_row_count);
+
+}  // namespace texture_compression
+
+}  // namespace kynetic
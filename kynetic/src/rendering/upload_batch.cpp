@@ -0,0 +1,146 @@
+//
+// Created by kenny on 12/3/25.
+//
+
+#include "upload_batch.hpp"
+
+#include "core/device.hpp"
+#include "core/engine.hpp"
+#include "core/thread_pool.hpp"
+#include "uploader.hpp"
+
+using namespace kynetic;
+
+UploadBatch::UploadBatch(size_t staging_budget) : m_staging_budget(staging_budget) {}
+
+UploadBatch::~UploadBatch()
+{
+    KX_ASSERT_MSG(m_buffer_uploads.empty() && m_image_uploads.empty(),
+                  "UploadBatch destroyed with pending uploads, did you forget to call ::flush?");
+}
+
+void UploadBatch::upload(VkBuffer buffer, VkDeviceSize offset, const void* data, size_t size)
+{
+    if (size == 0) return;
+    if (m_pending_size > 0 && m_pending_size + size > m_staging_budget) flush();
+
+    m_buffer_uploads.push_back({data, size, buffer, offset, {}});
+    m_pending_size = align_staging(m_pending_size) + size;
+}
+
+void UploadBatch::upload(VkBuffer buffer, VkDeviceSize offset, size_t size, std::function<void(void*)>&& fill)
+{
+    if (size == 0) return;
+    if (m_pending_size > 0 && m_pending_size + size > m_staging_budget) flush();
+
+    m_buffer_uploads.push_back({nullptr, size, buffer, offset, std::move(fill)});
+    m_pending_size = align_staging(m_pending_size) + size;
+}
+
+void UploadBatch::upload(const AllocatedImage& image, const void* data, size_t size)
+{
+    VkBufferImageCopy region{};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = image.extent;
+
+    upload(image, data, size, std::span(&region, 1));
+}
+
+void UploadBatch::upload(const AllocatedImage& image,
+                         const void* data,
+                         size_t size,
+                         std::span<const VkBufferImageCopy> regions)
+{
+    if (size == 0 || regions.empty()) return;
+    if (m_pending_size > 0 && m_pending_size + size > m_staging_budget) flush();
+
+    m_image_uploads.push_back({data, size, image.image, {regions.begin(), regions.end()}});
+    m_pending_size = align_staging(m_pending_size) + size;
+}
+
+UploadToken UploadBatch::flush()
+{
+    if (m_buffer_uploads.empty() && m_image_uploads.empty()) return 0;
+
+    Uploader& uploader = Engine::get().device().uploader();
+
+    const Uploader::Staging staging = uploader.allocate(m_pending_size);
+
+    auto* data = static_cast<char*>(staging.data);
+
+    std::vector<size_t> buffer_offsets(m_buffer_uploads.size());
+    std::vector<size_t> image_offsets(m_image_uploads.size());
+
+    std::vector<size_t> fills;
+
+    size_t staging_offset = 0;
+    for (size_t i = 0; i < m_buffer_uploads.size(); ++i)
+    {
+        staging_offset = align_staging(staging_offset);
+        if (m_buffer_uploads[i].data)
+            memcpy(data + staging_offset, m_buffer_uploads[i].data, m_buffer_uploads[i].size);
+        else
+            fills.push_back(i);
+        buffer_offsets[i] = staging_offset;
+        staging_offset += m_buffer_uploads[i].size;
+    }
+
+    Engine::get().threads().parallel_for(fills.size(),
+                                         [&](size_t fill_index)
+                                         {
+                                             const size_t i = fills[fill_index];
+                                             m_buffer_uploads[i].fill(data + buffer_offsets[i]);
+                                         });
+
+    for (size_t i = 0; i < m_image_uploads.size(); ++i)
+    {
+        staging_offset = align_staging(staging_offset);
+        memcpy(data + staging_offset, m_image_uploads[i].data, m_image_uploads[i].size);
+        image_offsets[i] = staging_offset;
+        staging_offset += m_image_uploads[i].size;
+    }
+
+    const UploadToken token = uploader.submit(
+        [&](const CommandBuffer& cmd)
+        {
+            for (size_t i = 0; i < m_buffer_uploads.size(); ++i)
+            {
+                const BufferUpload& upload = m_buffer_uploads[i];
+
+                VkBufferCopy copy{};
+                copy.srcOffset = staging.offset + buffer_offsets[i];
+                copy.dstOffset = upload.offset;
+                copy.size = upload.size;
+                cmd.copy_buffer(staging.buffer, upload.buffer, 1, &copy);
+            }
+
+            for (size_t i = 0; i < m_image_uploads.size(); ++i)
+            {
+                const ImageUpload& upload = m_image_uploads[i];
+
+                cmd.transition_image(upload.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+                std::vector<VkBufferImageCopy> regions = upload.regions;
+                for (VkBufferImageCopy& region : regions) region.bufferOffset += staging.offset + image_offsets[i];
+
+                cmd.copy_buffer_to_image(staging.buffer,
+                                         upload.image,
+                                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                         static_cast<uint32_t>(regions.size()),
+                                         regions.data());
+
+                cmd.transition_image(upload.image,
+                                     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            }
+        });
+
+    m_buffer_uploads.clear();
+    m_image_uploads.clear();
+    m_pending_size = 0;
+
+    return token;
+}
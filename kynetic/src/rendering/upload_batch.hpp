@@ -0,0 +1,66 @@
+//
+// Created by kenny on 12/3/25.
+//
+
+#pragma once
+
+#include "uploader.hpp"
+
+namespace kynetic
+{
+
+// Collects buffer and image uploads and records them into a single staging allocation and Uploader submit. Source memory
+// is only read on flush, so it has to stay alive until then. Flushing doesn't wait for the copies.
+class UploadBatch
+{
+    struct BufferUpload
+    {
+        const void* data;
+        size_t size;
+        VkBuffer buffer;
+        VkDeviceSize offset;
+
+        // Writes the data straight into staging memory instead of copying it, used when data is null.
+        std::function<void(void*)> fill;
+    };
+
+    struct ImageUpload
+    {
+        const void* data;
+        size_t size;
+        VkImage image;
+        // Buffer offsets are relative to data.
+        std::vector<VkBufferImageCopy> regions;
+    };
+
+    std::vector<BufferUpload> m_buffer_uploads;
+    std::vector<ImageUpload> m_image_uploads;
+
+    size_t m_pending_size{0};
+    size_t m_staging_budget;
+
+public:
+    explicit UploadBatch(size_t staging_budget = 64ull * 1024 * 1024);
+    ~UploadBatch();
+
+    UploadBatch(const UploadBatch&) = delete;
+    UploadBatch(UploadBatch&&) = delete;
+    UploadBatch& operator=(const UploadBatch&) = delete;
+    UploadBatch& operator=(UploadBatch&&) = delete;
+
+    // Flushes early if the upload would push the pending staging size over budget.
+    void upload(VkBuffer buffer, VkDeviceSize offset, const void* data, size_t size);
+    // Same as above, but fill produces the size bytes in place on flush. Fills run in parallel on the thread pool.
+    void upload(VkBuffer buffer, VkDeviceSize offset, size_t size, std::function<void(void*)>&& fill);
+    // Fills mip 0 of the image and leaves it in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+    void upload(const AllocatedImage& image, const void* data, size_t size);
+    // Same as above, but copies every region, buffer offsets in regions are relative to data.
+    void upload(const AllocatedImage& image, const void* data, size_t size, std::span<const VkBufferImageCopy> regions);
+
+    [[nodiscard]] size_t get_pending_size() const { return m_pending_size; }
+
+    // Returns the token of the submit, or 0 when nothing was pending.
+    UploadToken flush();
+};
+
+}  // namespace kynetic
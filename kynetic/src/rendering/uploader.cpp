@@ -0,0 +1,134 @@
+//
+// Created by kenny on 12/10/25.
+//
+
+#include "uploader.hpp"
+
+#include "core/device.hpp"
+
+using namespace kynetic;
+
+Uploader::Uploader(Device& device, VkQueue queue, uint32_t queue_family, size_t ring_size)
+    : m_device(device), m_queue(queue), m_queue_family(queue_family), m_ring_size(ring_size)
+{
+    VkSemaphoreTypeCreateInfo type_create_info{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+                                               .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+                                               .initialValue = 0};
+    VkSemaphoreCreateInfo semaphore_create_info = vk_init::semaphore_create_info();
+    semaphore_create_info.pNext = &type_create_info;
+    VK_CHECK(vkCreateSemaphore(m_device.get(), &semaphore_create_info, nullptr, &m_timeline));
+
+    m_ring = m_device.create_buffer(m_ring_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY);
+}
+
+Uploader::~Uploader()
+{
+    wait(m_last_token);
+    retire(false);
+
+    for (const CommandBuffer& cmd : m_free_command_buffers) cmd.shutdown();
+    for (const AllocatedBuffer& staging : m_dedicated_staging) m_device.destroy_buffer(staging);
+
+    m_device.destroy_buffer(m_ring);
+    vkDestroySemaphore(m_device.get(), m_timeline, nullptr);
+}
+
+void Uploader::retire(bool wait)
+{
+    if (wait && !m_in_flight.empty()) this->wait(m_in_flight.front().token);
+
+    while (!m_in_flight.empty() && is_complete(m_in_flight.front().token))
+    {
+        Submission& submission = m_in_flight.front();
+
+        m_ring_tail = submission.ring_end;
+        for (const AllocatedBuffer& staging : submission.dedicated_staging) m_device.destroy_buffer(staging);
+        m_free_command_buffers.push_back(submission.cmd);
+
+        m_in_flight.pop_front();
+    }
+}
+
+Uploader::Staging Uploader::allocate(size_t size)
+{
+    const uint64_t aligned_size = align_staging(size);
+    if (aligned_size > m_ring_size)
+    {
+        const AllocatedBuffer& staging = m_dedicated_staging.emplace_back(
+            m_device.create_buffer(aligned_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY));
+        return {staging.info.pMappedData, staging.buffer, 0};
+    }
+
+    // Ranges never wrap, the rest of the ring is skipped instead.
+    uint64_t offset = align_staging(m_ring_head);
+    if (offset % m_ring_size + aligned_size > m_ring_size) offset += m_ring_size - offset % m_ring_size;
+
+    while (offset + aligned_size - m_ring_tail > m_ring_size)
+    {
+        KX_ASSERT_MSG(!m_in_flight.empty(), "Staging ring is full of unsubmitted uploads, submit before allocating more.");
+        retire(true);
+    }
+
+    m_ring_head = offset + aligned_size;
+
+    const uint64_t ring_offset = offset % m_ring_size;
+    return {static_cast<char*>(m_ring.info.pMappedData) + ring_offset, m_ring.buffer, ring_offset};
+}
+
+UploadToken Uploader::submit(const std::function<void(const CommandBuffer&)>& record)
+{
+    retire(false);
+
+    CommandBuffer cmd;
+    if (m_free_command_buffers.empty())
+    {
+        cmd.init(m_device.get(), m_queue_family);
+    }
+    else
+    {
+        cmd = m_free_command_buffers.back();
+        m_free_command_buffers.pop_back();
+        cmd.reset();
+    }
+
+    const VkCommandBufferBeginInfo begin_info =
+        vk_init::command_buffer_begin_info(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    VK_CHECK(vkBeginCommandBuffer(cmd.get_handle(), &begin_info));
+
+    record(cmd);
+
+    VK_CHECK(vkEndCommandBuffer(cmd.get_handle()));
+
+    const UploadToken token = ++m_last_token;
+
+    // Later uploads may copy out of resources earlier ones wrote, the previous value orders them.
+    VkSemaphoreSubmitInfo wait_info = vk_init::semaphore_submit_info(VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_timeline);
+    wait_info.value = token - 1;
+    VkSemaphoreSubmitInfo signal_info = vk_init::semaphore_submit_info(VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_timeline);
+    signal_info.value = token;
+
+    VkCommandBufferSubmitInfo command_buffer_info = vk_init::command_buffer_submit_info(cmd.get_handle());
+    const VkSubmitInfo2 submit = vk_init::submit_info(&command_buffer_info, &signal_info, &wait_info);
+    VK_CHECK(vkQueueSubmit2(m_queue, 1, &submit, VK_NULL_HANDLE));
+
+    m_in_flight.push_back({cmd, token, m_ring_head, std::move(m_dedicated_staging)});
+    m_dedicated_staging.clear();
+
+    return token;
+}
+
+bool Uploader::is_complete(UploadToken token) const
+{
+    uint64_t value = 0;
+    VK_CHECK(vkGetSemaphoreCounterValue(m_device.get(), m_timeline, &value));
+    return value >= token;
+}
+
+void Uploader::wait(UploadToken token) const
+{
+    const VkSemaphoreWaitInfo wait_info{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+                                        .semaphoreCount = 1,
+                                        .pSemaphores = &m_timeline,
+                                        .pValues = &token};
+    VK_CHECK(vkWaitSemaphores(m_device.get(), &wait_info, UINT64_MAX));
+}
@@ -0,0 +1,86 @@
+//
+// Created by kenny on 12/10/25.
+//
+
+#pragma once
+
+#include "command_buffer.hpp"
+
+namespace kynetic
+{
+
+// Timeline value an upload submission signals, 0 is always complete.
+using UploadToken = uint64_t;
+
+// Satisfies the copy offset alignment of every format we upload, including block compressed ones. UploadBatch places its
+// copies inside the staging the Uploader hands out, so both sides align with this.
+constexpr uint64_t STAGING_ALIGNMENT = 16;
+
+constexpr uint64_t align_staging(uint64_t offset) { return (offset + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1); }
+
+// Submits uploads to the transfer queue out of a persistent staging ring, without waiting for them. Devices without a
+// separate transfer family use the graphics queue instead. Submissions complete in order, each one waits on the timeline
+// value of the one before it, and every frame waits on the last one before touching uploaded resources.
+class Uploader
+{
+    struct Submission
+    {
+        CommandBuffer cmd;
+        UploadToken token;
+        uint64_t ring_end;
+        std::vector<AllocatedBuffer> dedicated_staging;
+    };
+
+    class Device& m_device;
+    VkQueue m_queue;
+    uint32_t m_queue_family;
+
+    VkSemaphore m_timeline{VK_NULL_HANDLE};
+    UploadToken m_last_token{0};
+
+    AllocatedBuffer m_ring;
+    size_t m_ring_size;
+
+    // Positions only ever grow and are taken modulo the ring size, [m_ring_tail, m_ring_head) is still in use.
+    uint64_t m_ring_head{0};
+    uint64_t m_ring_tail{0};
+
+    std::deque<Submission> m_in_flight;
+    std::vector<CommandBuffer> m_free_command_buffers;
+    std::vector<AllocatedBuffer> m_dedicated_staging;
+
+    // Recycles every submission that completed, waiting for the oldest one first if wait is set.
+    void retire(bool wait);
+
+public:
+    struct Staging
+    {
+        void* data;
+        VkBuffer buffer;
+        VkDeviceSize offset;
+    };
+
+    Uploader(Device& device, VkQueue queue, uint32_t queue_family, size_t ring_size);
+    ~Uploader();
+
+    Uploader(const Uploader&) = delete;
+    Uploader(Uploader&&) = delete;
+    Uploader& operator=(const Uploader&) = delete;
+    Uploader& operator=(Uploader&&) = delete;
+
+    // Reserves staging memory for the next submit, blocking while in flight uploads fill the ring. Sizes beyond the ring get
+    // a staging buffer of their own, released once the submit completes.
+    Staging allocate(size_t size);
+
+    // Records the copies out of everything allocated since the last submit and submits them, returns right away.
+    UploadToken submit(const std::function<void(const CommandBuffer&)>& record);
+
+    [[nodiscard]] bool is_complete(UploadToken token) const;
+    void wait(UploadToken token) const;
+
+    [[nodiscard]] UploadToken get_last_token() const { return m_last_token; }
+    [[nodiscard]] VkSemaphore get_timeline() const { return m_timeline; }
+    [[nodiscard]] uint32_t get_queue_family() const { return m_queue_family; }
+};
+
+}  // namespace kynetic
@@ -11,7 +11,9 @@ using float3 = glm::vec3;
 using float4 = glm::vec4;
 using float4x4 = glm::mat4;
 
+using uint2 = glm::uvec2;
 using int2 = glm::ivec2;
+using int3 = glm::ivec3;
 #define column_major
 #endif
 
@@ -40,13 +42,14 @@ enum class DebugMeshletRenderMode
     Solid
 };
 
+// Quantized vertex attributes, positions live in their own tightly packed float3 stream. Decoded by the decode_vertex_*
+// helpers in shader_shared.slang.
 struct Vertex
 {
-    float3 normal;
-    float uv_x;
-    float4 color;
-    float4 tangent;
-    float uv_y;
+    uint32_t normal;   // octahedral, snorm16 x2
+    uint32_t tangent;  // octahedral, unorm15 x2, bitangent sign in bit 31
+    uint32_t uv;       // half x2
+    uint32_t color;    // rgba unorm8
 };
 
 struct MeshDrawData
@@ -56,11 +59,16 @@ struct MeshDrawData
     VkDeviceAddress meshlets;
     VkDeviceAddress meshlet_vertices;
     VkDeviceAddress meshlet_triangles;
-    VkDeviceAddress lod_groups;
+    VkDeviceAddress clusters;
+    VkDeviceAddress meshlet_positions;  // 0 when the mesh was built without quantized cluster positions
     uint32_t instance_index;
     uint32_t meshlet_count;
-    uint32_t lod_group_count;
-    uint32_t pad0;
+
+    float3 bounds_min;  // origin and step of the quantized ClusterData spheres
+    float bounds_step;
+
+    float position_step;
+    uint32_t pad0, pad1, pad2;
 };
 
 struct MeshDrawPushConstants
@@ -143,28 +151,39 @@ struct MaterialData
     uint32_t emissive;
 };
 
-struct MeshletData
+// Everything the amplification shader needs to cull and select a cluster, in one 32 byte fetch. Spheres are unorm16 x4,
+// center relative to MeshDrawData::bounds_min and radius, both in units of MeshDrawData::bounds_step.
+struct ClusterData
 {
-    float3 center;
-    float radius;
+    uint2 bounds;         // culling sphere
+    uint2 lod_bounds;     // sphere of the group this cluster was simplified from
+    uint2 parent_bounds;  // sphere of the group that simplifies this cluster
+    uint32_t errors;      // half x2 in steps: lod error, parent error. The lod error is 0 for the finest level
+    uint32_t cone;        // snorm8 x4: axis, cutoff
+};
 
-    int8_t cone_axis[3];
-    int8_t cone_cutoff;
+// Per cluster data only touched once a cluster has been accepted.
+struct MeshletData
+{
+    uint32_t vertex_offset;    // meshlet vertex index, addresses meshlet_positions
+    uint32_t triangle_offset;  // in packed 16-bit triangles
+    uint32_t index_offset;     // in 16-bit units of meshlet_vertices, word aligned for 32-bit indices
+    uint32_t vertex_base;
 
-    uint32_t vertex_offset;
-    uint32_t triangle_offset;
     uint8_t vertex_count;
     uint8_t triangle_count;
     uint8_t lod_level;
-    uint8_t pad0;
+    uint8_t vertex_index_bits;  // 16: deltas from vertex_base, 32: absolute indices
 
     int32_t group_id;
     int32_t parent_group_id;
+    uint32_t pad0;
 
-    float lod_error;
-    float parent_error;
+    int3 position_origin;  // cluster minimum on the mesh position grid, in steps
+    uint32_t pad1;
 };
 
+// Build side only, the GPU reads LOD group spheres through ClusterData.
 struct LODGroupData
 {
     float3 center;
@@ -0,0 +1,91 @@
+//
+// Created by kenny on 12/9/25.
+//
+
+#include "core/thread_pool.hpp"
+#include "rendering/model.hpp"
+
+#include <atomic>
+#include <charconv>
+
+using namespace kynetic;
+
+// Bakes glTF models into the asset cache without a window or a device, so build machines can produce the files the game
+// loads. Run it from the game's working directory, asset keys cover the model path as it is given here.
+//
+//   kynetic_bake [--no-compression] [--jobs <count>] <model.gltf>...
+int main(int argc, char** argv)
+{
+    bool compress = true;
+    uint32_t job_count = 0;
+    std::vector<std::filesystem::path> paths;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view argument = argv[i];
+        if (argument == "--no-compression")
+        {
+            compress = false;
+        }
+        else if (argument == "--jobs" && i + 1 < argc)
+        {
+            const std::string_view value = argv[++i];
+            if (std::from_chars(value.data(), value.data() + value.size(), job_count).ec != std::errc{})
+            {
+                fmt::print(stderr, "Invalid job count '{}'\n", value);
+                return 1;
+            }
+        }
+        else
+        {
+            paths.emplace_back(argument);
+        }
+    }
+
+    if (paths.empty())
+    {
+        fmt::print(stderr, "Usage: kynetic_bake [--no-compression] [--jobs <count>] <model.gltf>...\n");
+        return 1;
+    }
+
+    ThreadPool threads;
+
+    // Models are baked on their own threads and share the pool for their inner work. A model waits on its texture decodes,
+    // so it must never occupy a pool worker itself.
+    if (job_count == 0) job_count = std::max(threads.get_thread_count() / 4, 1u);
+    job_count = std::min(job_count, static_cast<uint32_t>(paths.size()));
+
+    // Every model in flight holds its own decoded textures, the budget is split between them.
+    const size_t texture_decode_budget = Model::DEFAULT_TEXTURE_DECODE_BUDGET / job_count;
+
+    std::atomic<size_t> next_path{0};
+    std::atomic<uint32_t> failures{0};
+
+    std::vector<std::thread> bakers;
+    bakers.reserve(job_count);
+    for (uint32_t i = 0; i < job_count; ++i)
+    {
+        bakers.emplace_back(
+            [&]
+            {
+                size_t index;
+                while ((index = next_path.fetch_add(1)) < paths.size())
+                {
+                    const std::filesystem::path& path = paths[index];
+                    if (Model::bake(path, threads, compress, texture_decode_budget))
+                    {
+                        fmt::print("Baked '{}'\n", path.string());
+                    }
+                    else
+                    {
+                        fmt::print(stderr, "Failed to bake '{}'\n", path.string());
+                        ++failures;
+                    }
+                }
+            });
+    }
+
+    for (std::thread& baker : bakers) baker.join();
+
+    return failures > 0 ? 1 : 0;
+}